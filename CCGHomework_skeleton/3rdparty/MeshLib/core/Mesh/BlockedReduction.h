@@ -0,0 +1,91 @@
+/*!
+ *      \file BlockedReduction.h
+ *      \brief Parallel reductions whose results do not depend on the number of threads
+ *
+ *      The partial results of fixed-length blocks are computed in parallel and
+ *      combined in block order, so the result is bitwise identical for any
+ *      number of threads. Only OpenMP 2.0 is needed, no array reductions.
+ */
+
+#ifndef _BLOCKED_REDUCTION_H_
+#define _BLOCKED_REDUCTION_H_
+
+#include <algorithm>
+#include <vector>
+
+namespace MeshLib
+{
+/*! block length of the reductions, it does not depend on the number of threads */
+const int REDUCTION_BLOCK_SIZE = 4096;
+
+/*!
+ *  Sum K quantities over the items [0, n)
+ *  \param n number of items
+ *  \param f f(i, s) adds the K quantities of item i to s[0..K-1]
+ *  \param sum output sums
+ */
+template <int K, typename F> void blocked_sum(int n, F f, double *sum)
+{
+    const int nb = (n + REDUCTION_BLOCK_SIZE - 1) / REDUCTION_BLOCK_SIZE;
+    std::vector<double> partial(nb * K, 0.0);
+
+#pragma omp parallel for schedule(static)
+    for (int b = 0; b < nb; ++b)
+    {
+        double *s = &partial[b * K];
+        const int end = std::min(n, (b + 1) * REDUCTION_BLOCK_SIZE);
+        for (int i = b * REDUCTION_BLOCK_SIZE; i < end; ++i)
+        {
+            f(i, s);
+        }
+    }
+
+    for (int k = 0; k < K; ++k)
+    {
+        sum[k] = 0;
+        for (int b = 0; b < nb; ++b)
+        {
+            sum[k] += partial[b * K + k];
+        }
+    }
+}
+
+/*!
+ *  Sum of f(i) over the items [0, n)
+ */
+template <typename F> double parallel_sum(int n, F f)
+{
+    double sum;
+    blocked_sum<1>(n, [&](int i, double *s) { s[0] += f(i); }, &sum);
+    return sum;
+}
+
+/*!
+ *  Maximum of f(i) over the items [0, n), and initial
+ */
+template <typename F> double parallel_max(int n, double initial, F f)
+{
+    const int nb = (n + REDUCTION_BLOCK_SIZE - 1) / REDUCTION_BLOCK_SIZE;
+    std::vector<double> partial(nb, initial);
+
+#pragma omp parallel for schedule(static)
+    for (int b = 0; b < nb; ++b)
+    {
+        const int end = std::min(n, (b + 1) * REDUCTION_BLOCK_SIZE);
+        double max = initial;
+        for (int i = b * REDUCTION_BLOCK_SIZE; i < end; ++i)
+        {
+            max = std::max(max, f(i));
+        }
+        partial[b] = max;
+    }
+
+    double max = initial;
+    for (int b = 0; b < nb; ++b)
+    {
+        max = std::max(max, partial[b]);
+    }
+    return max;
+}
+} // namespace MeshLib
+#endif // !_BLOCKED_REDUCTION_H_
@@ -0,0 +1,76 @@
+/*!
+ *      \file GraphPruner.h
+ *      \brief Prune the tree branches of a graph on the mesh edges
+ *
+ *      Used to turn the complement of a dual spanning tree into a cut graph,
+ *      the branches ending at valence-1 vertices are removed until only
+ *      loops remain.
+ */
+
+#ifndef _GRAPH_PRUNER_H_
+#define _GRAPH_PRUNER_H_
+
+#include <queue>
+#include <vector>
+
+namespace MeshLib
+{
+/*!
+ *  Prune the branches which are attached to valence-1 vertices, in one pass
+ *  driven by a queue of valence-1 vertices.
+ *  \param nv number of vertices
+ *  \param vertex_offset edges around each vertex, those of vertex v are
+ *  vertex_edge[vertex_offset[v]] to vertex_edge[vertex_offset[v + 1] - 1]
+ *  \param vertex_edge edges around the vertices
+ *  \param edge_vertex the two vertex indices of each edge
+ *  \param edge_flag true for the edges in the graph, the pruned ones are cleared
+ *  \param valence output, number of the remaining edges at each vertex
+ */
+inline void prune_graph(int nv, const int *vertex_offset, const int *vertex_edge, const int *edge_vertex,
+                        std::vector<bool> &edge_flag, std::vector<int> &valence)
+{
+    // A queue used to store valence-1 vertices
+    std::queue<int> vQueue;
+    valence.assign(nv, 0);
+
+    // 1. Compute the valence of each vertex once, and record all valence-1 vertices.
+    for (int v = 0; v < nv; v++)
+    {
+        for (int k = vertex_offset[v]; k < vertex_offset[v + 1]; k++)
+        {
+            if (edge_flag[vertex_edge[k]])
+                valence[v]++;
+        }
+
+        if (valence[v] == 1)
+            vQueue.push(v);
+    }
+
+    // 2. Remove the edge attached to each valence-1 vertex, the other end
+    //    loses one edge and joins the queue once it becomes valence-1 too.
+    while (!vQueue.empty())
+    {
+        int v = vQueue.front();
+        vQueue.pop();
+
+        if (valence[v] != 1)
+            continue;
+
+        for (int k = vertex_offset[v]; k < vertex_offset[v + 1]; k++)
+        {
+            int e = vertex_edge[k];
+            if (!edge_flag[e])
+                continue;
+
+            edge_flag[e] = false;
+            int w = (edge_vertex[2 * e] == v) ? edge_vertex[2 * e + 1] : edge_vertex[2 * e];
+            valence[v]--;
+            valence[w]--;
+            if (valence[w] == 1)
+                vQueue.push(w);
+            break;
+        }
+    }
+}
+} // namespace MeshLib
+#endif // !_GRAPH_PRUNER_H_
@@ -0,0 +1,615 @@
+/*!
+ *      \file MeshHierarchy.h
+ *      \brief Multiresolution hierarchy of a triangle mesh built by half-edge collapses
+ *
+ *      The hierarchy is computed on flat index arrays, the level meshes are rebuilt
+ *      on demand with the original vertex ids and positions. Every collapse records
+ *      the barycentric coordinates of the removed vertex in a face of the coarser
+ *      level, so that per-vertex quantities can be prolongated level by level.
+ */
+
+#ifndef _MESH_HIERARCHY_H_
+#define _MESH_HIERARCHY_H_
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+#include "Geometry/Point.h"
+#include "Mesh/BaseMesh.h"
+#include "Mesh/Iterators.h"
+
+namespace MeshLib
+{
+/*!
+ *  \brief CMeshHierarchy class
+ *
+ *  Level 0 is the input mesh, level k+1 keeps about ratio * #V(k) vertices.
+ *  Boundary vertices are never removed, so every level has the same boundary.
+ *  \tparam M mesh class, derived from CBaseMesh
+ */
+template <typename M> class CMeshHierarchy
+{
+  public:
+    /*!
+     *  A single half-edge collapse v -> w
+     */
+    struct CCollapse
+    {
+        /*! removed vertex */
+        int v;
+        /*! kept vertex */
+        int w;
+        /*! vertices of the coarse face containing v */
+        int p[3];
+        /*! barycentric coordinates of v in the coarse face */
+        double b[3];
+    };
+
+    /*!
+     *  CMeshHierarchy constructor
+     *  \param pMesh finest level mesh
+     */
+    CMeshHierarchy(M *pMesh);
+
+    /*!
+     *  Build the levels by greedy shortest edge collapses
+     *  \param min_vertices stop when a level has no more than min_vertices vertices
+     *  \param ratio target vertex ratio between two consecutive levels
+     */
+    void build(int min_vertices = 1000, double ratio = 0.25);
+
+    /*!
+     *  Number of levels, including the input mesh
+     */
+    int levels()
+    {
+        return (int)m_offset.size();
+    };
+
+    /*!
+     *  Number of vertices of a level
+     */
+    int numVertices(int level)
+    {
+        return m_num_vertices[level];
+    };
+
+    /*!
+     *  Hierarchy index of a vertex, all per vertex arrays are indexed by it
+     *  \param id vertex id
+     */
+    int index(int id)
+    {
+        return m_index[id];
+    };
+
+    /*!
+     *  Build the mesh of a level, level 0 returns the input mesh,
+     *  other levels are allocated and have to be deleted by the caller
+     */
+    M *mesh(int level);
+
+    /*!
+     *  Interpolate the values of vertices removed between level-1 and level
+     *  \param level the coarser level, whose values are already set
+     *  \param values per vertex values, indexed by index()
+     */
+    template <typename T> void prolong(int level, std::vector<T> &values);
+
+    /*!
+     *  Save the collapse sequence
+     */
+    bool write(const char *filename);
+
+    /*!
+     *  Load a collapse sequence saved from the same mesh, false without a
+     *  message if the file does not exist
+     */
+    bool read(const char *filename);
+
+  protected:
+    /*! Vertex neighbors of v in the current face list */
+    void _neighbors(int v, std::vector<int> &nbrs);
+
+    /*! Check link condition, valence and face flips for v -> w */
+    bool _collapsible(int v, int w);
+
+    /*! Perform v -> w on the face list */
+    void _collapse(int v, int w);
+
+    /*! Locate v in the fan of w after the collapse */
+    void _locate(int v, int w, CCollapse &c);
+
+    /*! Snapshot of the current faces and vertices as a new level */
+    void _push_level();
+
+    /*! Reset the working face list to the input mesh */
+    void _init();
+
+    /*! Fingerprint of the working mesh, to reject hierarchies of other meshes */
+    double _fingerprint();
+
+    /*! squared norm */
+    static double _norm2(const CPoint &p)
+    {
+        return p * p;
+    };
+
+    /*! squared distance from p to triangle abc, barycentric coordinates of the closest point */
+    static double _closest_point(const CPoint &p, const CPoint &a, const CPoint &b, const CPoint &c, double bary[3]);
+
+  protected:
+    /*! input mesh */
+    M *m_pMesh;
+    /*! vertex ids, positions, boundary flags */
+    std::vector<int> m_id;
+    std::vector<CPoint> m_point;
+    std::vector<bool> m_boundary;
+    /*! vertex id to hierarchy index */
+    std::vector<int> m_index;
+    /*! fingerprint of the input mesh */
+    double m_fingerprint;
+
+    /*! working faces, 3 indices per face */
+    std::vector<int> m_tri;
+    std::vector<bool> m_face_alive;
+    std::vector<bool> m_vertex_alive;
+    std::vector<std::vector<int>> m_vf;
+
+    /*! collapses, levels are contiguous ranges of it */
+    std::vector<CCollapse> m_collapses;
+    /*! number of collapses performed before each level */
+    std::vector<int> m_offset;
+    /*! faces of each level */
+    std::vector<std::vector<int>> m_level_faces;
+    /*! number of vertices of each level */
+    std::vector<int> m_num_vertices;
+};
+
+template <typename M> CMeshHierarchy<M>::CMeshHierarchy(M *pMesh) : m_pMesh(pMesh)
+{
+    int max_id = 0;
+    for (typename M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    {
+        typename M::CVertex *pV = *viter;
+        m_id.push_back(pV->id());
+        m_point.push_back(pV->point());
+        m_boundary.push_back(pV->boundary());
+        max_id = std::max(max_id, pV->id());
+    }
+    m_index.assign(max_id + 1, -1);
+    for (size_t i = 0; i < m_id.size(); i++)
+        m_index[m_id[i]] = (int)i;
+
+    _init();
+    m_fingerprint = _fingerprint();
+    m_offset.push_back(0);
+    m_level_faces.push_back(std::vector<int>());
+    m_num_vertices.push_back((int)m_id.size());
+}
+
+template <typename M> void CMeshHierarchy<M>::_init()
+{
+    m_tri.clear();
+    for (typename M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        for (typename M::FaceVertexIterator_ fviter(*fiter); !fviter.end(); ++fviter)
+            m_tri.push_back(m_index[(*fviter)->id()]);
+    }
+
+    int nf = (int)m_tri.size() / 3;
+    m_face_alive.assign(nf, true);
+    m_vertex_alive.assign(m_id.size(), true);
+    m_vf.assign(m_id.size(), std::vector<int>());
+    for (int f = 0; f < nf; f++)
+        for (int j = 0; j < 3; j++)
+            m_vf[m_tri[3 * f + j]].push_back(f);
+}
+
+template <typename M> double CMeshHierarchy<M>::_fingerprint()
+{
+    double sum = (double)m_tri.size();
+    for (size_t i = 0; i < m_point.size(); i++)
+        sum += (m_point[i][0] + 2 * m_point[i][1] + 3 * m_point[i][2]) * (double)(i % 97 + 1);
+    for (size_t i = 0; i < m_tri.size(); i++)
+        sum += (double)m_tri[i] * (double)(i % 89 + 1);
+    return sum;
+}
+
+template <typename M> void CMeshHierarchy<M>::_neighbors(int v, std::vector<int> &nbrs)
+{
+    nbrs.clear();
+    for (int f : m_vf[v])
+        for (int j = 0; j < 3; j++)
+        {
+            int u = m_tri[3 * f + j];
+            if (u != v && std::find(nbrs.begin(), nbrs.end(), u) == nbrs.end())
+                nbrs.push_back(u);
+        }
+}
+
+template <typename M> bool CMeshHierarchy<M>::_collapsible(int v, int w)
+{
+    if (!m_vertex_alive[v] || !m_vertex_alive[w] || m_boundary[v])
+        return false;
+
+    // the two faces sharing the edge, and their opposite vertices
+    int opposite[2], n = 0;
+    for (int f : m_vf[v])
+    {
+        int *t = &m_tri[3 * f];
+        if (t[0] != w && t[1] != w && t[2] != w)
+            continue;
+        if (n == 2)
+            return false;
+        for (int j = 0; j < 3; j++)
+            if (t[j] != v && t[j] != w)
+                opposite[n] = t[j];
+        n++;
+    }
+    if (n != 2 || opposite[0] == opposite[1])
+        return false;
+
+    // link condition: the common neighbors are exactly the two opposite vertices
+    std::vector<int> nv, nw;
+    _neighbors(v, nv);
+    _neighbors(w, nw);
+    int common = 0;
+    for (int u : nv)
+        if (std::find(nw.begin(), nw.end(), u) != nw.end())
+            common++;
+    if (common != 2)
+        return false;
+
+    // the opposite vertices lose one edge, keep them at least of valence 3
+    for (int k = 0; k < 2; k++)
+    {
+        std::vector<int> no;
+        _neighbors(opposite[k], no);
+        if ((int)no.size() <= 3)
+            return false;
+    }
+
+    // no face may flip or degenerate
+    const CPoint &pw = m_point[w];
+    for (int f : m_vf[v])
+    {
+        int *t = &m_tri[3 * f];
+        if (t[0] == w || t[1] == w || t[2] == w)
+            continue;
+        CPoint p[3], q[3];
+        for (int j = 0; j < 3; j++)
+        {
+            p[j] = m_point[t[j]];
+            q[j] = (t[j] == v) ? pw : p[j];
+        }
+        CPoint n0 = (p[1] - p[0]) ^ (p[2] - p[0]);
+        CPoint n1 = (q[1] - q[0]) ^ (q[2] - q[0]);
+        double l = _norm2(q[1] - q[0]) + _norm2(q[2] - q[1]) + _norm2(q[0] - q[2]);
+        if (n0 * n1 <= 0 || n1.norm() < 1e-3 * l)
+            return false;
+    }
+    return true;
+}
+
+template <typename M> void CMeshHierarchy<M>::_collapse(int v, int w)
+{
+    for (int f : m_vf[v])
+    {
+        int *t = &m_tri[3 * f];
+        if (t[0] == w || t[1] == w || t[2] == w)
+        {
+            m_face_alive[f] = false;
+            for (int j = 0; j < 3; j++)
+            {
+                if (t[j] == v)
+                    continue;
+                std::vector<int> &vf = m_vf[t[j]];
+                vf.erase(std::find(vf.begin(), vf.end(), f));
+            }
+        }
+        else
+        {
+            for (int j = 0; j < 3; j++)
+                if (t[j] == v)
+                    t[j] = w;
+            m_vf[w].push_back(f);
+        }
+    }
+    m_vf[v].clear();
+    m_vertex_alive[v] = false;
+}
+
+template <typename M> void CMeshHierarchy<M>::_locate(int v, int w, CCollapse &c)
+{
+    double best = -1;
+    for (int f : m_vf[w])
+    {
+        int *t = &m_tri[3 * f];
+        double bary[3];
+        double d = _closest_point(m_point[v], m_point[t[0]], m_point[t[1]], m_point[t[2]], bary);
+        if (best < 0 || d < best)
+        {
+            best = d;
+            for (int j = 0; j < 3; j++)
+            {
+                c.p[j] = t[j];
+                c.b[j] = bary[j];
+            }
+        }
+    }
+}
+
+template <typename M>
+double CMeshHierarchy<M>::_closest_point(const CPoint &p, const CPoint &a, const CPoint &b, const CPoint &c,
+                                         double bary[3])
+{
+    CPoint ab = b - a, ac = c - a, ap = p - a;
+    double d1 = ab * ap, d2 = ac * ap;
+    double u = 1, s = 0, t = 0;
+
+    CPoint bp = p - b;
+    double d3 = ab * bp, d4 = ac * bp;
+    CPoint cp = p - c;
+    double d5 = ab * cp, d6 = ac * cp;
+
+    double va = d3 * d6 - d5 * d4;
+    double vb = d5 * d2 - d1 * d6;
+    double vc = d1 * d4 - d3 * d2;
+
+    if (d1 <= 0 && d2 <= 0)
+    {
+        u = 1, s = 0, t = 0;
+    }
+    else if (d3 >= 0 && d4 <= d3)
+    {
+        u = 0, s = 1, t = 0;
+    }
+    else if (d6 >= 0 && d5 <= d6)
+    {
+        u = 0, s = 0, t = 1;
+    }
+    else if (vc <= 0 && d1 >= 0 && d3 <= 0)
+    {
+        s = d1 / (d1 - d3), u = 1 - s, t = 0;
+    }
+    else if (vb <= 0 && d2 >= 0 && d6 <= 0)
+    {
+        t = d2 / (d2 - d6), u = 1 - t, s = 0;
+    }
+    else if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+    {
+        t = (d4 - d3) / ((d4 - d3) + (d5 - d6)), s = 1 - t, u = 0;
+    }
+    else
+    {
+        double denom = 1.0 / (va + vb + vc);
+        s = vb * denom, t = vc * denom, u = 1 - s - t;
+    }
+
+    bary[0] = u, bary[1] = s, bary[2] = t;
+    CPoint q = a * u + b * s + c * t;
+    return _norm2(p - q);
+}
+
+template <typename M> void CMeshHierarchy<M>::_push_level()
+{
+    std::vector<int> faces;
+    for (size_t f = 0; f < m_face_alive.size(); f++)
+        if (m_face_alive[f])
+            faces.insert(faces.end(), &m_tri[3 * f], &m_tri[3 * f] + 3);
+
+    int nv = 0;
+    for (size_t i = 0; i < m_vertex_alive.size(); i++)
+        if (m_vertex_alive[i])
+            nv++;
+
+    m_offset.push_back((int)m_collapses.size());
+    m_level_faces.push_back(faces);
+    m_num_vertices.push_back(nv);
+}
+
+template <typename M> void CMeshHierarchy<M>::build(int min_vertices, double ratio)
+{
+    typedef std::pair<double, std::pair<int, int>> tEntry;
+
+    int nv = m_num_vertices.back();
+    while (nv > min_vertices)
+    {
+        int target = std::max(min_vertices, (int)(nv * ratio));
+
+        // seed the queue with all half-edges of the current level, edge lengths
+        // never change since the kept vertex stays in place
+        std::priority_queue<tEntry, std::vector<tEntry>, std::greater<tEntry>> queue;
+        std::vector<int> nbrs;
+        for (size_t v = 0; v < m_id.size(); v++)
+        {
+            if (!m_vertex_alive[v] || m_boundary[v])
+                continue;
+            _neighbors((int)v, nbrs);
+            for (int w : nbrs)
+                queue.push(tEntry(_norm2(m_point[v] - m_point[w]), std::make_pair((int)v, w)));
+        }
+
+        int count = nv;
+        while (count > target && !queue.empty())
+        {
+            int v = queue.top().second.first;
+            int w = queue.top().second.second;
+            queue.pop();
+            if (!_collapsible(v, w))
+                continue;
+
+            _collapse(v, w);
+
+            CCollapse c;
+            c.v = v;
+            c.w = w;
+            _locate(v, w, c);
+            m_collapses.push_back(c);
+            count--;
+
+            // neighborhood of w changed, offer its edges again
+            _neighbors(w, nbrs);
+            for (int u : nbrs)
+            {
+                double l = _norm2(m_point[u] - m_point[w]);
+                if (!m_boundary[w])
+                    queue.push(tEntry(l, std::make_pair(w, u)));
+                if (!m_boundary[u])
+                    queue.push(tEntry(l, std::make_pair(u, w)));
+            }
+        }
+
+        if (count == nv)
+            break;
+        _push_level();
+        std::cout << "Hierarchy level " << levels() - 1 << ": " << count << " vertices" << std::endl;
+        if (count > target)
+            break;
+        nv = count;
+    }
+}
+
+template <typename M> M *CMeshHierarchy<M>::mesh(int level)
+{
+    if (level == 0)
+        return m_pMesh;
+
+    std::vector<bool> used(m_id.size(), false);
+    std::vector<int> &faces = m_level_faces[level];
+    for (int i : faces)
+        used[i] = true;
+
+    M *pMesh = new M;
+    std::vector<typename M::CVertex *> verts(m_id.size(), NULL);
+    for (size_t i = 0; i < m_id.size(); i++)
+    {
+        if (!used[i])
+            continue;
+        verts[i] = pMesh->createVertex(m_id[i]);
+        verts[i]->point() = m_point[i];
+    }
+
+    for (size_t f = 0; f < faces.size() / 3; f++)
+    {
+        typename M::CVertex *v[3] = {verts[faces[3 * f]], verts[faces[3 * f + 1]], verts[faces[3 * f + 2]]};
+        pMesh->createFace(v, (int)f + 1);
+    }
+    pMesh->labelBoundary();
+    return pMesh;
+}
+
+template <typename M> template <typename T> void CMeshHierarchy<M>::prolong(int level, std::vector<T> &values)
+{
+    for (int k = m_offset[level] - 1; k >= m_offset[level - 1]; k--)
+    {
+        const CCollapse &c = m_collapses[k];
+        values[c.v] = values[c.p[0]] * c.b[0] + values[c.p[1]] * c.b[1] + values[c.p[2]] * c.b[2];
+    }
+}
+
+template <typename M> bool CMeshHierarchy<M>::write(const char *filename)
+{
+    std::ofstream os(filename);
+    if (!os.is_open())
+    {
+        std::cerr << "Error in opening file " << filename << std::endl;
+        return false;
+    }
+
+    os.precision(17);
+    os << m_id.size() << " " << m_offset.size() << " " << m_fingerprint << std::endl;
+    for (int o : m_offset)
+        os << o << " ";
+    os << std::endl;
+
+    for (const CCollapse &c : m_collapses)
+    {
+        os << m_id[c.v] << " " << m_id[c.w];
+        for (int j = 0; j < 3; j++)
+            os << " " << m_id[c.p[j]];
+        for (int j = 0; j < 3; j++)
+            os << " " << c.b[j];
+        os << std::endl;
+    }
+    return true;
+}
+
+template <typename M> bool CMeshHierarchy<M>::read(const char *filename)
+{
+    // a missing file is the usual first run, the caller builds the hierarchy
+    std::ifstream is(filename);
+    if (!is.is_open())
+        return false;
+
+    size_t nv, nl;
+    double fingerprint;
+    is >> nv >> nl >> fingerprint;
+    if (!is || nv != m_id.size() || nl == 0 ||
+        std::fabs(fingerprint - m_fingerprint) > 1e-9 * (1 + std::fabs(m_fingerprint)))
+    {
+        std::cerr << "Hierarchy " << filename << " does not match the mesh" << std::endl;
+        return false;
+    }
+
+    std::vector<int> offset(nl);
+    for (size_t l = 0; l < nl; l++)
+        is >> offset[l];
+
+    auto lookup = [&](int id) { return (id >= 0 && id < (int)m_index.size()) ? m_index[id] : -1; };
+
+    std::vector<CCollapse> collapses(nl > 0 ? offset.back() : 0);
+    for (CCollapse &c : collapses)
+    {
+        int id[5];
+        for (int j = 0; j < 5; j++)
+            is >> id[j];
+        for (int j = 0; j < 3; j++)
+            is >> c.b[j];
+        c.v = lookup(id[0]);
+        c.w = lookup(id[1]);
+        for (int j = 0; j < 3; j++)
+            c.p[j] = lookup(id[j + 2]);
+        if (!is || c.v < 0 || c.w < 0 || c.p[0] < 0 || c.p[1] < 0 || c.p[2] < 0)
+        {
+            std::cerr << "Hierarchy " << filename << " does not match the mesh" << std::endl;
+            return false;
+        }
+    }
+
+    // replay the collapses to rebuild the level meshes
+    _init();
+    m_collapses.clear();
+    m_offset.assign(1, 0);
+    m_level_faces.assign(1, std::vector<int>());
+    m_num_vertices.assign(1, (int)m_id.size());
+    for (size_t l = 1; l < nl; l++)
+    {
+        for (int k = offset[l - 1]; k < offset[l]; k++)
+        {
+            if (!_collapsible(collapses[k].v, collapses[k].w))
+            {
+                std::cerr << "Hierarchy " << filename << " does not match the mesh" << std::endl;
+                _init();
+                m_collapses.clear();
+                m_offset.assign(1, 0);
+                m_level_faces.assign(1, std::vector<int>());
+                m_num_vertices.assign(1, (int)m_id.size());
+                return false;
+            }
+            _collapse(collapses[k].v, collapses[k].w);
+            m_collapses.push_back(collapses[k]);
+        }
+        _push_level();
+    }
+    return true;
+}
+
+} // namespace MeshLib
+
+#endif // !_MESH_HIERARCHY_H_
@@ -0,0 +1,140 @@
+/*!
+ *      \file MeshSlicer.h
+ *      \brief Slice a mesh open along a cut graph in memory
+ *
+ *      The corners around each vertex are grouped into wedges separated by the
+ *      cut edges, every wedge becomes a vertex of the open mesh, whose father
+ *      is the id of the vertex in the input mesh.
+ */
+
+#ifndef _MESH_SLICER_H_
+#define _MESH_SLICER_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "Mesh/BaseMesh.h"
+#include "Mesh/Iterators.h"
+
+namespace MeshLib
+{
+/*!
+ *  \brief CMeshSlicer class
+ *
+ *  \tparam M input mesh class, whose edges have the sharp() trait marking the cut graph
+ *  \tparam N open mesh class, whose vertices have the father() trait
+ */
+template <typename M, typename N> class CMeshSlicer
+{
+  public:
+    /*!
+     *  CMeshSlicer constructor
+     *  \param pMesh input mesh with the cut graph
+     */
+    CMeshSlicer(M *pMesh)
+    {
+        m_pMesh = pMesh;
+    };
+
+    /*!
+     *  Slice the mesh along the sharp edges
+     *  \param pOpen empty mesh, receives the open mesh. The vertices are numbered
+     *  from 1, the faces keep their ids, point, normal and uv are copied.
+     *  \return number of vertices of the open mesh
+     */
+    int slice(N *pOpen);
+
+  protected:
+    /*! input mesh */
+    M *m_pMesh;
+};
+
+template <typename M, typename N> int CMeshSlicer<M, N>::slice(N *pOpen)
+{
+    typedef typename M::CVertex V;
+    typedef typename M::CHalfEdge H;
+
+    // wedge of each corner, a corner is the halfedge pointing to the vertex
+    std::unordered_map<H *, typename N::CVertex *> wedge;
+    wedge.reserve(3 * m_pMesh->numFaces());
+
+    int id = 1;
+    std::vector<H *> corners;
+    std::vector<int> root;
+    for (typename M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    {
+        V *pV = *viter;
+
+        corners.clear();
+        for (typename M::VertexInHalfedgeIterator_ hiter(m_pMesh, pV); !hiter.end(); ++hiter)
+            corners.push_back(*hiter);
+
+        // 1. union the corners which are adjacent across an uncut edge
+        const int n = (int)corners.size();
+        root.resize(n);
+        for (int i = 0; i < n; i++)
+            root[i] = i;
+
+        auto find = [&](int i) {
+            while (root[i] != i)
+                i = root[i] = root[root[i]];
+            return i;
+        };
+
+        for (int i = 0; i < n; i++)
+        {
+            H *pH = corners[i];
+            H *pS = m_pMesh->halfedgeSym(pH);
+            if (pS == NULL || m_pMesh->halfedgeEdge(pH)->sharp())
+                continue;
+
+            // the corner at the same vertex on the other side of the edge
+            H *pC = m_pMesh->halfedgePrev(pS);
+            for (int j = 0; j < n; j++)
+            {
+                if (corners[j] != pC)
+                    continue;
+                root[find(i)] = find(j);
+                break;
+            }
+        }
+
+        // 2. one vertex of the open mesh per wedge
+        std::vector<typename N::CVertex *> copies(n, NULL);
+        for (int i = 0; i < n; i++)
+        {
+            int r = find(i);
+            if (copies[r] == NULL)
+            {
+                typename N::CVertex *pW = pOpen->createVertex(id++);
+                pW->point() = pV->point();
+                pW->normal() = pV->normal();
+                pW->uv() = pV->uv();
+                pW->father() = pV->id();
+                copies[r] = pW;
+            }
+            wedge[corners[i]] = copies[r];
+        }
+    }
+
+    // 3. the faces, with the wedges of their corners
+    for (typename M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        typename M::CFace *pF = *fiter;
+
+        typename N::CVertex *v[3];
+        int k = 0;
+        for (typename M::FaceHalfedgeIterator_ fhiter(pF); !fhiter.end(); ++fhiter)
+        {
+            H *pH = *fhiter;
+            v[k++] = wedge[pH];
+        }
+        pOpen->createFace(v, pF->id());
+    }
+    pOpen->labelBoundary();
+
+    return id - 1;
+}
+
+} // namespace MeshLib
+#endif // !_MESH_SLICER_H_
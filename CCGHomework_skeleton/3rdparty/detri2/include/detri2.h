@@ -518,6 +518,7 @@ class EXPORTIT Triangulation
     int so_hilbert_limit;  // =8,
     int so_brio_threshold; // =64, -Sb#,#
     REAL so_brio_ratio;    // =0.125,
+    unsigned int so_randseed; // state of random_int(), set by sort_vertices()
 
     // Counters (ct_)
     int ct_in_vrts, ct_in_tris, ct_in_sdms;
@@ -603,6 +604,7 @@ class EXPORTIT Triangulation
     bool regular_test(Vertex *pa, Vertex *pb, Vertex *pc, Vertex *pd);
     int lawson_flip(Vertex *pt, int hullflag, arraypool *fqueue);
     int sort_vertices(Vertex *vrtarray, int, Vertex **&permutarray);
+    int random_int(int choices); // in [0, choices), independent of other triangulations
     int first_tri(Vertex **ptlist, int ptnum);
     int incremental_delaunay(Vertex **ptlist, int ptnum);
     int incremental_delaunay();
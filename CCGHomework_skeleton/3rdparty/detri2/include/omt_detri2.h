@@ -51,9 +51,32 @@ bool get_voronoi_cell(detri2::Triangulation *Tr, int vertex_index, std::vector<M
 EXPORTIT
 bool get_voronoi_edge(detri2::Triangulation *Tr, int vertex_index1, int vertex_index2, double &length);
 
+// All power cells and dual edge lengths at once. Cell i belongs to the vertex with index i + 1,
+// its corners are cell_points[cell_offsets[i]], ..., cell_points[cell_offsets[i + 1] - 1].
+EXPORTIT
+bool get_voronoi_diagram(detri2::Triangulation *Tr,
+                         /* output data */
+                         std::vector<int> &cell_offsets, std::vector<MeshLib::CPoint> &cell_points,
+                         std::vector<double> &cell_areas, std::vector<MeshLib::CPoint> &cell_centers,
+                         std::vector<std::pair<int, int>> &edge_list, std::vector<double> &dual_lengths);
+
+// The biased randomized insertion order (BRIO) of the points. order[k] is the 0-based index of the k-th point. The
+// points are split into rounds of sizes n * ratio^r, from the coarsest, each round is sorted along the Hilbert curve,
+// the first n * ratio^r points are a uniform random subsample of the points.
+EXPORTIT
+void get_brio_order(/* input data */
+                    std::vector<MeshLib::CPoint> &ptlist, double ratio,
+                    /* output data */
+                    std::vector<int> &order);
+
 // For visuliazation
 EXPORTIT
 bool export_Detri2_to_OMTmesh(detri2::Triangulation *Tr,   /* Input */
                               MeshLib::COMTMesh *OMTmesh); /* Output */
 
+// Update an exported OMTmesh in place, false if the triangulation has changed.
+EXPORTIT
+bool update_Detri2_to_OMTmesh(detri2::Triangulation *Tr,   /* Input */
+                              MeshLib::COMTMesh *OMTmesh); /* Input/Output */
+
 #endif //_OMT_DERTRI2_H_ defined
@@ -277,8 +277,9 @@ int  locate_hull_edge(Vertex *v, TriEdge &E) // for vertex interpolation
 //==============================================================================
 // P1 interpolation of vertex mesh size.
 
-int Triangulation::set_vertex_metric(Vertex *v, TriEdge &E)
+int Triangulation::set_vertex_metric(Vertex *v, TriEdge &E, int &iloc)
 {
+  iloc = LOC_IN_TRI;
   if (E.tri == NULL) {
     // Locate the vertex first.
     //assert(0); // to do...
@@ -305,8 +306,8 @@ int Triangulation::set_vertex_metric(Vertex *v, TriEdge &E)
   // skipped
   // Set vertex metric.
   if (OMT_domain) {
-    int loc = OMT_domain->locate_point(v, v->on_dm, 0);
-    TriEdge E = v->on_dm;
+    int loc = OMT_domain->locate_point(v, v->on_omt, 0);
+    TriEdge E = v->on_omt;
 
     if (loc == LOC_IN_OUTSIDE) {
       return 0; // assert(0); // The background mesh does not cover the mesh domain.
@@ -430,18 +431,19 @@ int Triangulation::set_vertex_metrics()
   */
   
   TriEdge E;
+  int loc;
 
   for (int i = 0; i < ct_in_vrts; i++) {
     if (in_vrts[i].typ == UNUSEDVERTEX) continue;
     E.tri = NULL;
-    set_vertex_metric(&in_vrts[i], E);
+    set_vertex_metric(&in_vrts[i], E, loc);
   }
   if (tr_steiners != NULL) {
     for (int i = 0; i < tr_steiners->used_items; i++) {
       Vertex *v = (Vertex *) tr_steiners->get(i);
       if (v->is_deleted()) continue;
       E.tri = NULL;
-      set_vertex_metric(v, E);
+      set_vertex_metric(v, E, loc);
     }
   }
 
@@ -1032,13 +1034,19 @@ int Triangulation::smooth_vertices()
   int mcount = 0; // count the number of moved vertices.
 
   if (op_smooth_criterion == SMOOTH_LAPLACIAN) {
-    printf("\nUsing Lapacian smoother\n");
+    if (op_db_verbose) {
+      printf("\nUsing Lapacian smoother\n");
+    }
     mcount = get_laplacian_centers(massptlist);
   } else if (op_smooth_criterion == SMOOTH_CVT) {
-    printf("\nUsing CVT smoother\n");
+    if (op_db_verbose) {
+      printf("\nUsing CVT smoother\n");
+    }
     mcount = get_powercell_mass_centers(massptlist);
   } else if (op_smooth_criterion == SMOOTH_DISTMESH) {
-    printf("\nUsing DISTMESH smoother\n");
+    if (op_db_verbose) {
+      printf("\nUsing DISTMESH smoother\n");
+    }
     mcount = get_distmesh_points(massptlist);
   } else {
     printf("Smooth option not available yet.\n");
@@ -1135,7 +1143,7 @@ int Triangulation::smooth_vertices()
     mcpt->wei = mesh_vert->wei;
     mcpt->val = mesh_vert->val;
     mcpt->typ = mesh_vert->typ;
-    mcpt->on_dm = mesh_vert->on_dm; // for set_vertex_metric()
+    mcpt->on_omt = mesh_vert->on_omt; // for set_vertex_metric()
 
     // Remove this vertex from the triangulation.
     if (!remove_point(mesh_vert, fqueue)) {
@@ -1181,7 +1189,7 @@ int Triangulation::smooth_vertices()
     newpt->wei = mcpt->wei; // the weight
     newpt->val = mcpt->val; // mesh size
     newpt->typ = mcpt->typ;
-    newpt->on_dm = mcpt->on_dm;
+    newpt->on_omt = mcpt->on_omt;
     //newpt->Pair = mcpt->Pair;
 
     if (op_metric > 0) {
@@ -9,7 +9,7 @@ using  namespace detri2;
 
 //==============================================================================
 
-bool Triangulation::is_ridge_vertex(Vertex *v)
+bool Triangulation::is_fixed_vertex(Vertex *v)
 {
   // Count how many segments at this vertex (from the link list).
   // Debug: check the correctness of the link list.
@@ -234,7 +234,7 @@ int Triangulation::remove_segment(Triang* seg)
     }
     
     if (v->is_fixed()) {
-      if (!is_ridge_vertex(v)) {
+      if (!is_fixed_vertex(v)) {
         v->clear_fix();
       }
     }
@@ -287,7 +287,7 @@ int Triangulation::insert_segment(TriEdge E, int stag, REAL val, Triang** pseg)
     // If the vertex is not fixed, it might become fixed (e.g., insert_segment case).
     //if (!seg->vrt[j]->is_fixed()) {
       // Check if it becomes a ridge vertex (un-removable).
-      if (is_ridge_vertex(seg->vrt[j])) {
+      if (is_fixed_vertex(seg->vrt[j])) {
         seg->vrt[j]->set_fix();
       } else {
         seg->vrt[j]->clear_fix();
@@ -384,7 +384,7 @@ int Triangulation::find_direction(TriEdge& E, Vertex *pt)
     } else if (s1 < 0) {
       if (s2 > 0) {
         // Rotate randomly
-        if (rand() % 2) {
+        if (random_int(2)) {
           E = E.eprev_esym(); // ccw
           s1 = s2;
           s2 = Orient2d(pa, E.apex(), pt);
@@ -798,7 +798,7 @@ int Triangulation::recover_segments()
           seg->vrt[j]->on_bd = TriEdge(seg, j);
           seg->vrt[j]->on_bd.tri->nei[j] = pseg;
           // Check if it becomes a ridge vertex (un-removable).
-          if (is_ridge_vertex(seg->vrt[j])) {
+          if (is_fixed_vertex(seg->vrt[j])) {
             seg->vrt[j]->set_fix();
           } else {
             seg->vrt[j]->clear_fix();
@@ -858,7 +858,7 @@ int Triangulation::set_ridgevertices()
     Vertex *v = &(in_vrts[i]);
     if (v->typ == UNUSEDVERTEX) continue;
     //if (!v->is_fixed()) {
-      if (is_ridge_vertex(v)) {
+      if (is_fixed_vertex(v)) {
         v->set_fix();
         rcount++;
       }
@@ -921,7 +921,7 @@ int Triangulation::set_ridgevertices()
       Vertex *v = (Vertex *) tr_steiners->get(i);
       if (v->is_deleted()) continue;
       //if (!v->is_fixed()) {
-        if (is_ridge_vertex(v)) {
+        if (is_fixed_vertex(v)) {
           v->set_fix();
           rcount++;
         }
@@ -65,7 +65,7 @@ int Triangulation::locate_point(Vertex *pt, TriEdge &E, int encflag)
         E.ver = _enext_tbl[E.ver]; 
       } else if (ori2 < 0) {
         // Randomly choose one.
-        if (rand() % 2) { // flipping a coin.
+        if (random_int(2)) { // flipping a coin.
           E.ver = _enext_tbl[E.ver];
         } else {
           E.ver = _eprev_tbl[E.ver];
@@ -200,19 +200,6 @@ int Triangulation::locate_point(Vertex *pt, TriEdge &E, int encflag)
   //return LOC_IN_TRI; // P lies inside E = [a,b,c]
 }
 
-//==============================================================================
-// Insert a vertex using Bowyer-Watson algorithm
-// if `bwflag' is true, use Bowyer-Watson algorithm to enlarge cavity.
-
-bool Triangulation::insert_point(Vertex *pt, TriEdge &E, int& loc, bool bwflag)
-{
-  if (loc == LOC_UNKNOWN) {
-    loc = locate_point(pt, E, 0);
-  }
-
-  return true;
-}
-
 //==============================================================================
 // Given two triangles [a,b,c] and [b,a,d], check if the edge [a,b]
 //   is locally regular, i.e., locally Delaunay in Euclidean metric.
@@ -226,46 +213,21 @@ bool Triangulation::insert_point(Vertex *pt, TriEdge &E, int& loc, bool bwflag)
 
 bool Triangulation::regular_test(Vertex* pa, Vertex* pb, Vertex* pc, Vertex* pd)
 {
-  if (op_metric <= METRIC_Euclidean) {
-    //printf("  O3d: (%d, %d, %d, %d)\n", tt[0].org()->idx, tt[0].dest()->idx, tt[0].apex()->idx, tt[1].apex()->idx);
-    //return (Orient3d(pa, pb, pc, pd) * op_dt_nearest) > 0;
-    // bakup heights
-    double ha = pa->crd[2];
-    double hb = pb->crd[2];
-    double hc = pc->crd[2];
-    double hd = pd->crd[2];
-    // calculate heights
-    double x, y;
-    _set_height(pa);
-    _set_height(pb);
-    _set_height(pc);
-    _set_height(pd);
-    double s = (Orient3d(pa, pb, pc, pd) * op_dt_nearest);
-    // Retstor heights
-    pa->crd[2] = ha;
-    pb->crd[2] = hb;
-    pc->crd[2] = hc;
-    pd->crd[2] = hd;
-    return s > 0;
-  } else if (op_metric == METRIC_Riemannian) {
-    // bakup heights
-    double ha = pa->crd[2];
-    double hb = pb->crd[2];
-    double hc = pc->crd[2];
-    double hd = pd->crd[2];
-    // calculate heights
+  // The heights are (re-)calculated from the weights and kept in crd[2], so
+  //   that the lifted points are valid for the later Orient3d() tests.
+  if (op_metric == METRIC_Euclidean_no_weight) {
+    pa->crd[2] = pa->crd[0]*pa->crd[0] + pa->crd[1]*pa->crd[1];
+    pb->crd[2] = pb->crd[0]*pb->crd[0] + pb->crd[1]*pb->crd[1];
+    pc->crd[2] = pc->crd[0]*pc->crd[0] + pc->crd[1]*pc->crd[1];
+    pd->crd[2] = pd->crd[0]*pd->crd[0] + pd->crd[1]*pd->crd[1];
+    return (Orient3d(pa, pb, pc, pd) * op_dt_nearest) > 0;
+  } else if (op_metric <= METRIC_Riemannian) {
     double x, y;
     _set_height(pa);
     _set_height(pb);
     _set_height(pc);
     _set_height(pd);
-    double s = (Orient3d(pa, pb, pc, pd) * op_dt_nearest);
-    // Retstor heights
-    pa->crd[2] = ha;
-    pb->crd[2] = hb;
-    pc->crd[2] = hc;
-    pd->crd[2] = hd;
-    return s > 0;
+    return (Orient3d(pa, pb, pc, pd) * op_dt_nearest) > 0;
   } else {
     assert(0); // not supported yet.
   }
@@ -371,9 +333,6 @@ int Triangulation::lawson_flip(Vertex *pt, int hullflag, arraypool *fqueue)
     if (pte->tri->is_deleted()) continue;
     if (!pte->is_edge_infected()) continue; // is it still in queue?
     pte->clear_edge_infect();
-    if (pt != NULL) {
-      if (pte->apex() != pt) continue;
-    }
     // Check if this edge is locally regular.
     ori = false; ishullflip = 0;
     tt[0] = *pte;
@@ -453,16 +412,19 @@ int Triangulation::sort_vertices(Vertex* vrtarray, int arysize, Vertex**& permut
     }
   } else {
     // Randomly permute the vertices.
-    srand(arysize);
+    so_randseed = arysize;
     for (i = 0; i < arysize; i++) {
-      randindex = rand() % (i + 1); 
+      randindex = random_int(i + 1);
       permutarray[i] = permutarray[randindex];
       permutarray[randindex] = &vrtarray[i];
     }
   }
 
   if (!so_nosort && !so_nobrio) { // no -SN or -SB
-    hilbert_init(2);
+    // The Gray code tables are global, they are initialized once, also if
+    //   several triangulations are sorted concurrently.
+    static const int hilbert_initialized = (hilbert_init(2), 1);
+    (void) hilbert_initialized;
     brio_multiscale_sort2(permutarray, arysize, so_brio_threshold,
                           so_brio_ratio, so_hilbert_order, so_hilbert_limit,
                           io_xmin, io_xmax, io_ymin, io_ymax);
@@ -471,6 +433,16 @@ int Triangulation::sort_vertices(Vertex* vrtarray, int arysize, Vertex**& permut
   return 1;
 }
 
+//==============================================================================
+// A linear congruential generator with the state in the triangulation, unlike
+// rand(), triangulations built on several threads do not share it.
+
+int Triangulation::random_int(int choices)
+{
+  so_randseed = so_randseed * 1103515245u + 12345u;
+  return (int) ((so_randseed >> 16) % (unsigned int) choices);
+}
+
 //==============================================================================
 
 int Triangulation::first_tri(Vertex **ptlist, int ptnum)
@@ -499,7 +471,7 @@ int Triangulation::first_tri(Vertex **ptlist, int ptnum)
       // Randomly select three vertices from the iuput list.
       for (i = 0; i < 3; i++) {
         // Swap ith and jth element.
-        j = rand() % (ptnum - i);
+        j = random_int(ptnum - i);
         swappt = ptlist[i];
         ptlist[i] = ptlist[j];
         ptlist[j] = swappt;
@@ -544,18 +516,9 @@ int Triangulation::first_tri(Vertex **ptlist, int ptnum)
 
 //==============================================================================
 
-int Triangulation::incremental_delaunay()
+int Triangulation::incremental_delaunay(Vertex **vrtarray, int arysize)
 {
-  if (op_db_verbose) {
-    printf("Incremental Delaunay construction...\n");
-  }
-
-  Vertex** vrtarray = NULL;
-  int arysize = ct_in_vrts;
-
-  sort_vertices(in_vrts, ct_in_vrts, vrtarray);
-
-  if (!first_tri(vrtarray, ct_in_vrts)) {
+  if (!first_tri(vrtarray, arysize)) {
     return 0;
   }
 
@@ -567,52 +530,51 @@ int Triangulation::incremental_delaunay()
     if (op_db_verbose > 1) {
       printf("  Inserting vertex %d: %d\n", i+1, vrtarray[i]->idx);
     }
-    //loc = locate_point(vrtarray[i], E, 0, 0); // encflag = 0
     loc = locate_point(vrtarray[i], E, 0); // encflag = 0
     if (loc != LOC_ON_VERT) { // ON_VERTEX
-      REAL ori = 1.0;
-      if (loc == LOC_IN_TRI) { //if ((loc == 1) && !E.tri->is_hulltri()) {
-        // Make sure this vertex is regular w.r.t. E.
-        // An interior edge.
-        ori = Orient3d(E.org(), E.dest(), E.apex(), vrtarray[i])
-            * op_dt_nearest;
-      }
-      if (ori > 0) {
-        // Insert vertex
-        tt[0] = E;
-        if (loc == LOC_IN_OUTSIDE) { // IN outise
-          int fflag = FLIP_13;
-          flip(tt, &(vrtarray[i]), fflag, fqueue);
-        } else if (loc == LOC_IN_TRI) { // IN_TRAING
-          int fflag = FLIP_13;
-          flip(tt, &(vrtarray[i]), fflag, fqueue);
-        } else if (loc == LOC_ON_EDGE) { // ON_EDGE
-          int fflag = FLIP_24;
-          //tt[1] = tt[0].esym();
-          flip(tt, &(vrtarray[i]), fflag, fqueue);
-        } else {
-          printf(" loc = %d\n", loc);
-          assert(0); // not possible for encflag = 0
-        }
-        lawson_flip(vrtarray[i], 1, fqueue); // hullflag = 1
-        E = vrtarray[i]->adj; // For next point location.
+      // Insert the vertex. If it is not regular, i.e., it lies above the
+      //   lifted triangulation, it is removed again by lawson_flip().
+      tt[0] = E;
+      if ((loc == LOC_IN_OUTSIDE) || (loc == LOC_IN_TRI)) {
+        int fflag = FLIP_13;
+        flip(tt, &(vrtarray[i]), fflag, fqueue);
+      } else if (loc == LOC_ON_EDGE) { // ON_EDGE
+        int fflag = FLIP_24;
+        flip(tt, &(vrtarray[i]), fflag, fqueue);
       } else {
-        if (op_db_verbose > 1) {
-          printf("  Skip a redundant vertex %d\n", vrtarray[i]->idx);
-        }
+        printf(" loc = %d\n", loc);
       }
+      lawson_flip(vrtarray[i], 1, fqueue); // hullflag = 1
+      E = vrtarray[i]->adj; // For next point location.
     } else {
       if (op_db_verbose) {
         printf("Warning:  Vertex %d is coincident with %d\n",
                vrtarray[i]->idx, E.org()->idx);
       }
       vrtarray[i]->Pair = E.org(); // Remember this vertex.
-      assert(vrtarray[i]->typ == UNUSEDVERTEX);
       // the ct_unused_vrts is updated by flip13();
     }
   }
 
   delete fqueue;
+  return 1;
+}
+
+int Triangulation::incremental_delaunay()
+{
+  if (op_db_verbose) {
+    printf("Incremental Delaunay construction...\n");
+  }
+
+  // Use the weights if they are given.
+  if (op_metric <= METRIC_Euclidean) {
+    op_metric = io_with_wei ? METRIC_Euclidean : METRIC_Euclidean_no_weight;
+  }
+
+  Vertex** vrtarray = NULL;
+  sort_vertices(in_vrts, ct_in_vrts, vrtarray);
+  incremental_delaunay(vrtarray, ct_in_vrts);
+
   delete [] vrtarray;
   return 1;
 }
@@ -7,7 +7,6 @@
 
 using  namespace detri2;
 
-double detri2::PI = 3.14159265358979323846264338327950288419716939937510582;
 
 extern int metric_use_gmp; // an option set by op_use_gmp (must initialise it)
 
@@ -171,9 +170,9 @@ void Vertex::print()
     printf("  on_bd: x%lx v(%d) [%d,%d]\n", (unsigned long) on_bd.tri, on_bd.ver,
            on_bd.tri->vrt[0]->idx, on_bd.tri->vrt[1]->idx);
   }
-  if (on_dm.tri != NULL) {
-    printf("  on_dm: x%lx v(%d) [%d,%d,%d]\n", (unsigned long) on_dm.tri, on_dm.ver,
-           on_dm.org()->idx, on_dm.dest()->idx, on_dm.apex()->idx);
+  if (on_omt.tri != NULL) {
+    printf("  on_omt: x%lx v(%d) [%d,%d,%d]\n", (unsigned long) on_omt.tri, on_omt.ver,
+           on_omt.org()->idx, on_omt.dest()->idx, on_omt.apex()->idx);
   }
 }
 
@@ -948,9 +947,10 @@ void Triangulation::reset_options()
   op_round_flip = 0;
   op_use_coarsening = 1;
   op_use_splitting = 1;
-  op_use_smoothing = 0;
+  op_use_smoothing = 1;
   op_max_iter = 3;
   op_smooth_criterion = 1;
+  op_smooth_iter = 3;
   op_ada_use_intpoints = 2;
   op_save_inter_meshes = 0;
   op_minlen = 0.0;
@@ -983,15 +983,16 @@ void Triangulation::reset_options()
   so_hilbert_limit = 8;
   so_brio_threshold = 64;
   so_brio_ratio = 0.125;
+  so_randseed = 1;
 
   io_noindices = 0;
   io_firstindex = 0;
   io_poly = 0;
   io_inria_mesh = 0;
-  io_with_metric = io_with_sol = io_with_grd = 0;
+  io_with_metric = io_with_sol = io_with_grd = io_with_wei = 0;
   io_voronoi = 0;
   io_point_array = 0;
-  io_no_unused = 0;
+  io_keep_unused = 0;
   io_outedges = 0;
   io_out_voronoi = 0;
   io_dump_to_ucd = 0;
@@ -1004,7 +1005,8 @@ void Triangulation::reset_options()
   io_metric_min = io_metric_max = 0.;
   io_diagonal = io_diagonal2 = 0.0;
   io_tol_rel_gap = 1.e-3;
-  io_tol_minangle = 0.1 * PI / 180.0; // Radian
+  io_tol_minangle = 0.01 * PI / 180.0; // Radian
+  op_tol_min_minangle = io_tol_minangle;
 
   ct_in_vrts = ct_in_tris = ct_in_sdms = 0;
   ct_hullsize = ct_exteriors = 0;
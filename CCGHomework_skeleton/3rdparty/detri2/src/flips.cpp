@@ -229,10 +229,10 @@ int Triangulation::flip22(TriEdge *tt)
   nn[2] = (tt[1].enext()).esym(); // [a,d]
   nn[3] = (tt[1].eprev()).esym(); // [d,b]
 
-  if (tt[0].tri->is_hulltri()) {
-    assert(tt[1].tri->is_hulltri());
-    ct_hullsize-=2;
-  }
+  // A hull triangle may be flipped with an interior one, see
+  //   remove_skinny_hulltris().
+  if (tt[0].tri->is_hulltri()) ct_hullsize--;
+  if (tt[1].tri->is_hulltri()) ct_hullsize--;
   if (tt[0].tri->is_exterior()) {
     assert(tt[1].tri->is_exterior());
     is_ext = true; 
@@ -682,8 +682,8 @@ int Triangulation::flip_check(TriEdge *te)
     }
     */
     if (!pb->is_fixed()) {
-      //assert(!is_ridge_vertex(pb)); // Only for debug
-      if (is_ridge_vertex(pb)) {
+      //assert(!is_fixed_vertex(pb)); // Only for debug
+      if (is_fixed_vertex(pb)) {
         printf("Failed:  vertex %d is a ridge vertex, but it is not fixed.\n", pb->idx);
         assert(0);
       }
@@ -709,8 +709,8 @@ int Triangulation::flip_check(TriEdge *te)
     }
     */
     if (!pa->is_fixed()) {
-      //assert(!is_ridge_vertex(pa)); // only for debug
-      if (is_ridge_vertex(pa)) {
+      //assert(!is_fixed_vertex(pa)); // only for debug
+      if (is_fixed_vertex(pa)) {
         printf("Failed:  vertex %d is a ridge vertex, but it is not fixed.\n", pa->idx);
         assert(0);
       }
@@ -981,6 +981,16 @@ int Triangulation::flip(TriEdge tt[4], Vertex** ppt, int& fflag, arraypool* fque
       tt[i].set_edge_infect();
       * (TriEdge *) fqueue->alloc() = tt[i];
     }
+    if ((fflag == FLIP_13) || (fflag == FLIP_24)) {
+      // Also add the new edges at the inserted vertex, it is removed again
+      //   (by a 3-1 or 4-2 flip) if it is not regular.
+      TriEdge E = (*ppt)->adj;
+      do {
+        E.set_edge_infect();
+        * (TriEdge *) fqueue->alloc() = E;
+        E = E.eprev_esym(); // ccw
+      } while (E.tri != (*ppt)->adj.tri);
+    }
   }
 
   tr_recnttri = tt[0].tri; // Remember a recent triangle.
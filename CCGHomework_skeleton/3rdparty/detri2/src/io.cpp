@@ -220,7 +220,7 @@ int Triangulation::parse_commands(int argc, char* argv[])
         } else if (argv[i][j+1] == 'e') { // -Ie
           io_outedges = 1; j++;
         } else if (argv[i][j+1] == 'J') { // -IJ
-          io_no_unused = 1; j++;
+          io_keep_unused = 1; j++;
         } else if (argv[i][j+1] == 'd') { // -Id
           io_dump_to_ucd = 1; j++;
         } else if (argv[i][j+1] == 'l') { // -Il
@@ -559,6 +559,7 @@ int Triangulation::read_weights()
       if (i < wnum) {
         printf("Missing %d point weights from file %s.\n", wnum - i, filename);
       }
+      io_with_wei = 1;
     } else {
       printf("Wrong number %d (should be %d) of point weights\n", wnum, ct_in_vrts);
     }
@@ -0,0 +1,706 @@
+/*!
+ *      \file omt_detri2.cpp
+ *      \brief Interface between OMT and Detri2
+ *
+ *      Generate and update the weighted DT of the OMT target points, and extract
+ *      its power diagram clipped by the OMT domain.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "omt_detri2.h"
+
+using namespace detri2;
+
+//==============================================================================
+// Push the edges of the triangles around pt into the flip queue.
+
+static void enqueue_star(Vertex *pt, arraypool *fqueue)
+{
+    TriEdge E = pt->adj;
+    do
+    {
+        // E = [pt, b, c], [pt, b] and its link edge [b, c].
+        TriEdge N = E.enext();
+        if (!E.is_edge_infected())
+        {
+            E.set_edge_infect();
+            *(TriEdge *)fqueue->alloc() = E;
+        }
+        if (!N.is_edge_infected())
+        {
+            N.set_edge_infect();
+            *(TriEdge *)fqueue->alloc() = N;
+        }
+        E = E.eprev_esym(); // ccw rotate
+    } while (E.tri != pt->adj.tri);
+}
+
+//==============================================================================
+// Check that the edges of the triangles around pt are locally regular.
+
+static bool is_regular_star(Triangulation *Tr, Vertex *pt)
+{
+    TriEdge E = pt->adj;
+    do
+    {
+        TriEdge N = E.enext();
+        TriEdge tt[2] = {E, N};
+        for (int i = 0; i < 2; i++)
+        {
+            TriEdge S = tt[i].esym();
+            if (tt[i].tri->is_hulltri() || S.tri->is_hulltri())
+                continue;
+            if (Tr->regular_test(tt[i].org(), tt[i].dest(), tt[i].apex(), S.apex()))
+                return false;
+        }
+        E = E.eprev_esym(); // ccw rotate
+    } while (E.tri != pt->adj.tri);
+
+    return true;
+}
+
+//==============================================================================
+// Flip the locally non-regular interior edges in the queue, as lawson_flip()
+// with hullflag = 0. The origins of the edges which cannot be flipped (their
+// quadrilateral is not convex) are returned in unflipped.
+
+static int flip_queue(Triangulation *Tr, arraypool *fqueue, std::vector<Vertex *> &unflipped)
+{
+    TriEdge tt[4];
+    Vertex *delpt = NULL;
+    int fcount = 0;
+
+    for (int i = 0; i < fqueue->used_items; i++)
+    {
+        TriEdge *pte = (TriEdge *)fqueue->get(i);
+        if (pte->tri->is_deleted())
+            continue;
+        if (!pte->is_edge_infected())
+            continue; // is it still in queue?
+        pte->clear_edge_infect();
+
+        tt[0] = *pte;
+        tt[1] = tt[0].esym();
+        if (tt[0].tri->is_hulltri() || tt[1].tri->is_hulltri())
+            continue;
+        if (!Tr->regular_test(tt[0].org(), tt[0].dest(), tt[0].apex(), tt[1].apex()))
+            continue;
+
+        int fflag = FLIP_UNKNOWN;
+        if (Tr->flip(tt, &delpt, fflag, fqueue))
+            fcount++;
+        else
+            unflipped.push_back(tt[0].org());
+    }
+
+    fqueue->clean();
+    return fcount;
+}
+
+//==============================================================================
+// Insert an unused vertex if it lies below the lifted triangulation. If force
+// is set, a redundant vertex is lifted just below the triangulation first.
+
+static bool insert_weighted_point(Triangulation *Tr, Vertex *pt, bool force, arraypool *fqueue)
+{
+    TriEdge E;
+    int loc = Tr->locate_point(pt, E, 0);
+    if (loc == LOC_ON_VERT)
+        return false; // coincident with another vertex.
+
+    if (loc == LOC_ON_EDGE && E.tri->is_hulltri())
+        E = E.esym();
+
+    if (!E.tri->is_hulltri())
+    {
+        REAL ori = Orient3d(E.org(), E.dest(), E.apex(), pt) * Tr->op_dt_nearest;
+        if (ori <= 0)
+        {
+            if (!force)
+                return false;
+
+            // height of the lifted triangle E at pt
+            Vertex *pa = E.org(), *pb = E.dest(), *pc = E.apex();
+            REAL area = Orient2d(pa, pb, pc);
+            REAL la = Orient2d(pt, pb, pc) / area;
+            REAL lb = Orient2d(pa, pt, pc) / area;
+            REAL lc = 1.0 - la - lb;
+            REAL h = la * pa->crd[2] + lb * pb->crd[2] + lc * pc->crd[2];
+
+            pt->crd[2] = h - 1e-12 * (1.0 + fabs(h));
+            pt->wei = pt->crd[0] * pt->crd[0] + pt->crd[1] * pt->crd[1] - pt->crd[2];
+        }
+    }
+
+    TriEdge tt[4];
+    tt[0] = E;
+    int fflag = (loc == LOC_ON_EDGE) ? FLIP_24 : FLIP_13;
+    Tr->flip(tt, &pt, fflag, fqueue);
+    Tr->lawson_flip(pt, 1, fqueue); // hullflag = 1
+
+    return true;
+}
+
+//==============================================================================
+// The robust predicates use global error bounds, which exactinit() resets and
+// recomputes, it must not run while other threads use them. They are set once,
+// the static filters are off in 2d and do not depend on the bounding box.
+
+static void init_predicates()
+{
+    static const bool initialized = (exactinit(0, 0, 0, 0, 1.0, 1.0, 0), true);
+    (void)initialized;
+}
+
+//==============================================================================
+// Generate initial weighted DT.
+//
+// The points are indexed from 1 in boundary_edge_list and missing_point_list.
+// If boundary edges are given, the exterior triangles are removed, and the mesh
+// is refined and smoothed if refine_mesh_flag is set.
+
+bool generate_wdt(std::vector<MeshLib::CPoint> &ptlist, std::vector<double> &input_weights,
+                  std::vector<std::pair<int, int>> &boundary_edge_list, bool refine_mesh_flag,
+                  Triangulation **outputTr, std::vector<int> &missing_point_list)
+{
+    Triangulation *Tr = new Triangulation;
+    strcpy(Tr->io_outfilename, "dump_triang");
+    Tr->io_with_wei = 1;
+    Tr->io_firstindex = 1;
+
+    int n = (int)ptlist.size();
+    Tr->ct_in_vrts = n;
+    Tr->in_vrts = new Vertex[n];
+
+    Tr->io_xmin = Tr->io_ymin = 1.e+30;
+    Tr->io_xmax = Tr->io_ymax = -1.e+30;
+    for (int i = 0; i < n; i++)
+    {
+        Vertex *vrt = &(Tr->in_vrts[i]);
+        vrt->init();
+        vrt->crd[0] = ptlist[i][0];
+        vrt->crd[1] = ptlist[i][1];
+        vrt->wei = input_weights[i];
+        vrt->idx = i + Tr->io_firstindex;
+        vrt->typ = UNUSEDVERTEX;
+        Tr->ct_unused_vrts++;
+
+        Tr->io_xmin = vrt->crd[0] < Tr->io_xmin ? vrt->crd[0] : Tr->io_xmin;
+        Tr->io_xmax = vrt->crd[0] > Tr->io_xmax ? vrt->crd[0] : Tr->io_xmax;
+        Tr->io_ymin = vrt->crd[1] < Tr->io_ymin ? vrt->crd[1] : Tr->io_ymin;
+        Tr->io_ymax = vrt->crd[1] > Tr->io_ymax ? vrt->crd[1] : Tr->io_ymax;
+    }
+
+    init_predicates();
+
+    Tr->incremental_delaunay();
+
+    if (!boundary_edge_list.empty())
+    {
+        Tr->tr_segs = new arraypool(sizeof(Triang), 10);
+        for (size_t i = 0; i < boundary_edge_list.size(); i++)
+        {
+            int a = boundary_edge_list[i].first - Tr->io_firstindex;
+            int b = boundary_edge_list[i].second - Tr->io_firstindex;
+            if ((a == b) || (a < 0) || (a >= n) || (b < 0) || (b >= n))
+            {
+                printf("Segment %d has invalid vertices.\n", (int)i + Tr->io_firstindex);
+                continue;
+            }
+            Triang *seg = (Triang *)Tr->tr_segs->alloc();
+            seg->init();
+            seg->vrt[0] = &(Tr->in_vrts[a]);
+            seg->vrt[1] = &(Tr->in_vrts[b]);
+            seg->tag = -1;
+        }
+
+        Tr->recover_segments();
+        Tr->set_subdomains();
+        Tr->remove_exteriors();
+
+        if (refine_mesh_flag)
+        {
+            Tr->op_metric = METRIC_Euclidean_no_weight;
+            Tr->delaunay_refinement();
+            for (int i = 0; i < Tr->op_smooth_iter; i++)
+                Tr->smooth_vertices();
+        }
+    }
+
+    if (Tr->ct_unused_vrts > 0)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            if (Tr->in_vrts[i].typ == UNUSEDVERTEX)
+                missing_point_list.push_back(Tr->in_vrts[i].idx);
+        }
+    }
+
+    *outputTr = Tr;
+    return true;
+}
+
+//==============================================================================
+// The biased randomized insertion order of the points, as used by
+// incremental_delaunay(), with the round size ratio.
+
+void get_brio_order(std::vector<MeshLib::CPoint> &ptlist, double ratio, std::vector<int> &order)
+{
+    Triangulation Tr;
+    Tr.io_firstindex = 0;
+    Tr.so_brio_ratio = ratio;
+
+    int n = (int)ptlist.size();
+    Tr.ct_in_vrts = n;
+    Tr.in_vrts = new Vertex[n];
+
+    Tr.io_xmin = Tr.io_ymin = 1.e+30;
+    Tr.io_xmax = Tr.io_ymax = -1.e+30;
+    for (int i = 0; i < n; i++)
+    {
+        Vertex *vrt = &(Tr.in_vrts[i]);
+        vrt->init();
+        vrt->crd[0] = ptlist[i][0];
+        vrt->crd[1] = ptlist[i][1];
+        vrt->idx = i;
+
+        Tr.io_xmin = vrt->crd[0] < Tr.io_xmin ? vrt->crd[0] : Tr.io_xmin;
+        Tr.io_xmax = vrt->crd[0] > Tr.io_xmax ? vrt->crd[0] : Tr.io_xmax;
+        Tr.io_ymin = vrt->crd[1] < Tr.io_ymin ? vrt->crd[1] : Tr.io_ymin;
+        Tr.io_ymax = vrt->crd[1] > Tr.io_ymax ? vrt->crd[1] : Tr.io_ymax;
+    }
+
+    Vertex **permutarray = NULL;
+    Tr.sort_vertices(Tr.in_vrts, n, permutarray);
+
+    order.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        order[i] = permutarray[i]->idx;
+    }
+    delete[] permutarray;
+}
+
+//==============================================================================
+// Update a given weighted DT whose vertex weights are changed.
+//
+// new_vertex_weights is indexed as the point list of generate_wdt(). Only the
+// stars of the vertices whose weight changed are flipped; vertices which were
+// missing are inserted again once they are regular. The missing points are
+// returned as 1-based indices, as by generate_wdt(). If insert_missing_point
+// is set, the missing points are inserted with the smallest weight that keeps
+// them, and updated_vertex_weights returns the weights in Tr.
+//
+// Returns false if flips could not recover the weighted DT (the lifted surface
+// is not convex), the caller should generate it again.
+
+bool remesh_wdt(Triangulation *Tr, std::vector<double> *new_vertex_weights, bool insert_missing_point,
+                std::vector<int> *missing_point_list, std::vector<double> *updated_vertex_weights)
+{
+    arraypool *fqueue = new arraypool(sizeof(TriEdge), 10);
+
+    // 1. set the new weights and heights, collect the stars of the changed vertices
+    for (int i = 0; i < Tr->ct_in_vrts; i++)
+    {
+        Vertex *pt = &(Tr->in_vrts[i]);
+        REAL w = (*new_vertex_weights)[i];
+        if (w == pt->wei)
+            continue;
+
+        pt->wei = w;
+        pt->crd[2] = pt->crd[0] * pt->crd[0] + pt->crd[1] * pt->crd[1] - w;
+        if (pt->typ == UNUSEDVERTEX)
+            continue;
+
+        enqueue_star(pt, fqueue);
+    }
+
+    // 2. flip the queued edges, redundant vertices are removed by 3-1 flips
+    std::vector<Vertex *> unflipped;
+    flip_queue(Tr, fqueue, unflipped);
+
+    bool regular = true;
+    for (size_t i = 0; i < unflipped.size() && regular; i++)
+    {
+        if (unflipped[i]->typ != UNUSEDVERTEX)
+            regular = is_regular_star(Tr, unflipped[i]);
+    }
+
+    // 3. insert the missing vertices which are regular again, an inserted vertex may
+    // become redundant by the later ones
+    for (int i = 0; i < Tr->ct_in_vrts && Tr->ct_unused_vrts > 0; i++)
+    {
+        Vertex *pt = &(Tr->in_vrts[i]);
+        if (pt->typ == UNUSEDVERTEX)
+            insert_weighted_point(Tr, pt, insert_missing_point, fqueue);
+    }
+
+    if (missing_point_list != NULL)
+    {
+        missing_point_list->clear();
+        for (int i = 0; i < Tr->ct_in_vrts && Tr->ct_unused_vrts > 0; i++)
+        {
+            if (Tr->in_vrts[i].typ == UNUSEDVERTEX)
+                missing_point_list->push_back(i + 1);
+        }
+    }
+
+    if (updated_vertex_weights != NULL)
+    {
+        updated_vertex_weights->resize(Tr->ct_in_vrts);
+        for (int i = 0; i < Tr->ct_in_vrts; i++)
+            (*updated_vertex_weights)[i] = Tr->in_vrts[i].wei;
+    }
+
+    delete fqueue;
+    return regular;
+}
+
+//==============================================================================
+// Calculate the Voronoi (power) vertices of Tr, the power cells are clipped by
+// OMT_domain, or by Tr itself if it is NULL.
+
+bool get_voronoi_vertices(Triangulation *Tr, Triangulation *OMT_domain)
+{
+    Tr->OMT_domain = OMT_domain != NULL ? OMT_domain : Tr;
+    if (Tr->ct_exteriors > 0)
+        Tr->remove_exteriors();
+    Tr->remove_skinny_hulltris();
+
+    // the orthocenters of the hull triangles depend on the interior ones
+    int idx = 0;
+    for (int i = 0; i < Tr->tr_tris->used_items; i++)
+    {
+        Triang *tri = (Triang *)Tr->tr_tris->get(i);
+        if (tri->is_deleted() || tri->is_hulltri())
+            continue;
+        Tr->get_tri_orthocenter(tri);
+        tri->idx = idx++;
+    }
+    for (int i = 0; i < Tr->tr_tris->used_items; i++)
+    {
+        Triang *tri = (Triang *)Tr->tr_tris->get(i);
+        if (tri->is_deleted() || !tri->is_hulltri())
+            continue;
+        Tr->get_hulltri_orthocenter(tri);
+        tri->idx = idx++;
+    }
+
+    return true;
+}
+
+//==============================================================================
+// The vertices of Tr which are in the triangulation, the input ones followed by
+// the Steiner points. This is the order of the vertex indices of the OMTmesh.
+
+static void get_mesh_vertices(Triangulation *Tr, std::vector<Vertex *> &vrts)
+{
+    vrts.clear();
+    vrts.reserve(Tr->ct_in_vrts);
+    for (int i = 0; i < Tr->ct_in_vrts; i++)
+    {
+        if (Tr->in_vrts[i].typ != UNUSEDVERTEX)
+            vrts.push_back(&(Tr->in_vrts[i]));
+    }
+    if (Tr->tr_steiners != NULL)
+    {
+        for (int i = 0; i < Tr->tr_steiners->used_items; i++)
+        {
+            Vertex *vrt = (Vertex *)Tr->tr_steiners->get(i);
+            if (!vrt->is_deleted())
+                vrts.push_back(vrt);
+        }
+    }
+}
+
+//==============================================================================
+// The input vertex of Tr with the 1-based index, or NULL.
+
+static Vertex *get_input_vertex(Triangulation *Tr, int vertex_index)
+{
+    if (vertex_index < 1 || vertex_index > Tr->ct_in_vrts)
+        return NULL;
+    Vertex *vrt = &(Tr->in_vrts[vertex_index - 1]);
+    return vrt->idx == vertex_index ? vrt : NULL;
+}
+
+//==============================================================================
+// The area and the mass center of a power cell given by its corners in ccw order.
+
+static void get_polygon_mass_center(Vertex *pts, int ptnum, double &area, MeshLib::CPoint &masspt)
+{
+    double A = 0, cx = 0, cy = 0;
+    for (int i = 0; i < ptnum; i++)
+    {
+        Vertex *p = &(pts[i]);
+        Vertex *q = &(pts[(i + 1) % ptnum]);
+        double c = p->crd[0] * q->crd[1] - q->crd[0] * p->crd[1];
+        A += 0.5 * c;
+        cx += (p->crd[0] + q->crd[0]) * c;
+        cy += (p->crd[1] + q->crd[1]) * c;
+    }
+    area = fabs(A);
+    masspt[0] = cx / (6.0 * A);
+    masspt[1] = cy / (6.0 * A);
+}
+
+//==============================================================================
+// The power cell of a vertex, its corners in ccw order, its area and its mass
+// center. get_voronoi_vertices() must be called first.
+
+bool get_voronoi_cell(Triangulation *Tr, int vertex_index, std::vector<MeshLib::CPoint> &ptlist, double &area,
+                      MeshLib::CPoint &masspt)
+{
+    area = 0;
+    Vertex *vrt = get_input_vertex(Tr, vertex_index);
+    if (vrt == NULL)
+        return false;
+
+    Vertex *pts = NULL;
+    int ptnum = 0;
+    if (!Tr->get_powercell(vrt, &pts, &ptnum))
+        return false;
+
+    for (int i = 0; i < ptnum; i++)
+        ptlist.push_back(MeshLib::CPoint(pts[i].crd[0], pts[i].crd[1], pts[i].crd[2]));
+    get_polygon_mass_center(pts, ptnum, area, masspt);
+
+    delete[] pts;
+    return true;
+}
+
+//==============================================================================
+// The length of the dual edge of the mesh edge E.
+
+static bool get_dual_edge_length(Triangulation *Tr, TriEdge &E, double &length)
+{
+    Vertex dual[2];
+    int ptnum = 0;
+    if (!Tr->get_dual_edge(E, dual, NULL, &ptnum))
+        return false;
+
+    double dx = dual[1].crd[0] - dual[0].crd[0];
+    double dy = dual[1].crd[1] - dual[0].crd[1];
+    length = sqrt(dx * dx + dy * dy);
+    return true;
+}
+
+//==============================================================================
+// The length of the dual edge of the edge [vertex_index1, vertex_index2].
+// get_voronoi_vertices() must be called first.
+
+bool get_voronoi_edge(Triangulation *Tr, int vertex_index1, int vertex_index2, double &length)
+{
+    length = 0;
+    Vertex *v1 = get_input_vertex(Tr, vertex_index1);
+    Vertex *v2 = get_input_vertex(Tr, vertex_index2);
+    if (v1 == NULL || v2 == NULL)
+        return false;
+
+    TriEdge E;
+    if (!Tr->get_edge(v1, v2, E))
+        return false;
+
+    return get_dual_edge_length(Tr, E, length);
+}
+
+//==============================================================================
+// A power cell (or a dual edge) is interior if the orthocenters of all its triangles
+// lie inside the OMT_domain. Only the other ones are cut by the domain boundary, which
+// updates the boundary edges cached in Triang::omt, so they are not computed in parallel.
+
+static bool is_interior_dual(Triang *tri)
+{
+    return !tri->is_hulltri() && !tri->is_dual_in_exterior() && !tri->is_dual_on_bdry();
+}
+
+static bool is_interior_cell(Vertex *vrt)
+{
+    TriEdge E = vrt->adj;
+    if (E.tri == NULL)
+        return false;
+    do
+    {
+        if (!is_interior_dual(E.tri))
+            return false;
+        E = E.eprev_esym(); // ccw rotate
+    } while (E.tri != vrt->adj.tri);
+    return true;
+}
+
+//==============================================================================
+// All power cells and dual edge lengths of Tr, the vertices are in the order of
+// export_Detri2_to_OMTmesh() and the edges in the order of the triangles.
+// get_voronoi_vertices() must be called first.
+
+bool get_voronoi_diagram(Triangulation *Tr, std::vector<int> &cell_offsets, std::vector<MeshLib::CPoint> &cell_points,
+                         std::vector<double> &cell_areas, std::vector<MeshLib::CPoint> &cell_centers,
+                         std::vector<std::pair<int, int>> &edge_list, std::vector<double> &dual_lengths)
+{
+    std::vector<Vertex *> vrts;
+    get_mesh_vertices(Tr, vrts);
+    int n = (int)vrts.size();
+
+    // 1. the corners of the cells, the boundary ones first
+    std::vector<Vertex *> ptlists(n, NULL);
+    std::vector<int> ptnums(n, 0);
+    std::vector<char> interior(n);
+    for (int i = 0; i < n; i++)
+    {
+        interior[i] = is_interior_cell(vrts[i]);
+        if (!interior[i])
+            Tr->get_powercell(vrts[i], &ptlists[i], &ptnums[i]);
+    }
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < n; i++)
+    {
+        if (interior[i])
+            Tr->get_powercell(vrts[i], &ptlists[i], &ptnums[i]);
+    }
+
+    // 2. pack the corners, the areas and the mass centers
+    cell_offsets.assign(n + 1, 0);
+    for (int i = 0; i < n; i++)
+        cell_offsets[i + 1] = cell_offsets[i] + ptnums[i];
+    cell_points.resize(cell_offsets[n]);
+    cell_areas.assign(n, 0);
+    cell_centers.assign(n, MeshLib::CPoint());
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+    {
+        Vertex *pts = ptlists[i];
+        if (pts == NULL)
+            continue;
+        for (int j = 0; j < ptnums[i]; j++)
+            cell_points[cell_offsets[i] + j] = MeshLib::CPoint(pts[j].crd[0], pts[j].crd[1], pts[j].crd[2]);
+        get_polygon_mass_center(pts, ptnums[i], cell_areas[i], cell_centers[i]);
+        delete[] pts;
+    }
+
+    // 3. the dual edges, each edge is taken from the triangle with the smaller index,
+    // the hull triangles have the largest ones
+    std::vector<TriEdge> edges;
+    edges.reserve(3 * Tr->tr_tris->objects / 2 + Tr->ct_hullsize);
+    edge_list.clear();
+    for (int i = 0; i < Tr->tr_tris->used_items; i++)
+    {
+        Triang *tri = (Triang *)Tr->tr_tris->get(i);
+        if (tri->is_deleted() || tri->is_hulltri())
+            continue;
+        TriEdge E;
+        E.tri = tri;
+        for (E.ver = 0; E.ver < 3; E.ver++)
+        {
+            if (tri->idx < E.esym().tri->idx)
+            {
+                edges.push_back(E);
+                edge_list.push_back(std::pair<int, int>(E.org()->idx, E.dest()->idx));
+            }
+        }
+    }
+    int m = (int)edges.size();
+    dual_lengths.assign(m, 0);
+    for (int i = 0; i < m; i++)
+    {
+        if (!is_interior_dual(edges[i].tri) || !is_interior_dual(edges[i].esym().tri))
+            get_dual_edge_length(Tr, edges[i], dual_lengths[i]);
+    }
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < m; i++)
+    {
+        if (is_interior_dual(edges[i].tri) && is_interior_dual(edges[i].esym().tri))
+            get_dual_edge_length(Tr, edges[i], dual_lengths[i]);
+    }
+
+    return true;
+}
+
+//==============================================================================
+// Copy the triangulation to OMTmesh, the vertices are renumbered from 1 and their
+// uv are the point coordinates, the dual point of a face is the orthocenter.
+
+bool export_Detri2_to_OMTmesh(Triangulation *Tr, MeshLib::COMTMesh *OMTmesh)
+{
+    std::vector<Vertex *> vrts;
+    get_mesh_vertices(Tr, vrts);
+    Tr->io_firstindex = 1;
+    for (size_t i = 0; i < vrts.size(); i++)
+    {
+        Vertex *vrt = vrts[i];
+        vrt->idx = (int)i + 1;
+        MeshLib::COMTVertex *pV = OMTmesh->createVertex(vrt->idx);
+        pV->uv() = MeshLib::CPoint2(vrt->crd[0], vrt->crd[1]);
+    }
+
+    Tr->OMT_domain = NULL;
+    for (int i = 0; i < Tr->tr_tris->used_items; i++)
+    {
+        Triang *tri = (Triang *)Tr->tr_tris->get(i);
+        if (tri->is_deleted() || tri->is_hulltri())
+            continue;
+        MeshLib::COMTVertex *v[3];
+        for (int j = 0; j < 3; j++)
+            v[j] = OMTmesh->idVertex(tri->vrt[j]->idx);
+        MeshLib::COMTFace *pF = OMTmesh->createFace(v, i + 1);
+        Tr->get_tri_orthocenter(tri);
+        pF->dual_point() = MeshLib::CPoint(tri->cct[0], tri->cct[1], tri->cct[2]);
+    }
+
+    return true;
+}
+
+//==============================================================================
+// Update an OMTmesh exported from Tr before, if Tr has still the same vertices and
+// triangles (e.g., no flip was done), only the vertices are renumbered and the dual
+// points of the faces are recalculated. Otherwise it returns false and OMTmesh must
+// be exported again.
+
+bool update_Detri2_to_OMTmesh(Triangulation *Tr, MeshLib::COMTMesh *OMTmesh)
+{
+    std::vector<Vertex *> vrts;
+    get_mesh_vertices(Tr, vrts);
+    if ((int)vrts.size() != OMTmesh->numVertices())
+        return false;
+    Tr->io_firstindex = 1;
+    for (size_t i = 0; i < vrts.size(); i++)
+        vrts[i]->idx = (int)i + 1;
+
+    int fcount = 0;
+    for (int i = 0; i < Tr->tr_tris->used_items; i++)
+    {
+        Triang *tri = (Triang *)Tr->tr_tris->get(i);
+        if (tri->is_deleted() || tri->is_hulltri())
+            continue;
+        MeshLib::COMTFace *pF = OMTmesh->idFace(i + 1);
+        if (pF == NULL)
+            return false;
+        int k = 0;
+        for (MeshLib::COMTMesh::FaceVertexIterator fviter(pF); !fviter.end(); fviter++)
+        {
+            int id = (*fviter)->id();
+            if (id != tri->vrt[0]->idx && id != tri->vrt[1]->idx && id != tri->vrt[2]->idx)
+                return false;
+            k++;
+        }
+        if (k != 3)
+            return false;
+        fcount++;
+    }
+    if (fcount != OMTmesh->numFaces())
+        return false;
+
+    Tr->OMT_domain = NULL;
+    for (int i = 0; i < Tr->tr_tris->used_items; i++)
+    {
+        Triang *tri = (Triang *)Tr->tr_tris->get(i);
+        if (tri->is_deleted() || tri->is_hulltri())
+            continue;
+        Tr->get_tri_orthocenter(tri);
+        OMTmesh->idFace(i + 1)->dual_point() = MeshLib::CPoint(tri->cct[0], tri->cct[1], tri->cct[2]);
+    }
+
+    return true;
+}
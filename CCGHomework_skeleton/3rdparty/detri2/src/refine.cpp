@@ -115,8 +115,8 @@ int Triangulation::check_segment(Vertex *pt, TriEdge &S, arraypool *encsegs)
 
 //==============================================================================
 
-int Triangulation::split_enc_segment(TriEdge &S, Vertex *encpt, arraypool *fqueue,
-                                 arraypool *encsegs, arraypool *enctris)
+int Triangulation::split_enc_segment(TriEdge &S, Vertex *encpt, bool mtrflag,
+                                 arraypool *fqueue, arraypool *encsegs, arraypool *enctris)
 {
   if (op_db_verbose > 2) {
     printf("    Split encroached segment [%d, %d]\n", S.org()->idx, S.dest()->idx);
@@ -184,9 +184,12 @@ int Triangulation::split_enc_segment(TriEdge &S, Vertex *encpt, arraypool *fqueu
   //  newvrt->crd[2] = newvrt->crd[0]*newvrt->crd[0]+newvrt->crd[1]*newvrt->crd[1];
   //} else {
     //newvrt->on_dm = e1->on_dm; // for searching in OMT_domain (may not be used).
-    TriEdge G = S;
-    if (G.tri->is_hulltri()) G = G.esym();
-    set_vertex_metric(newvrt, G);
+    if (mtrflag) {
+      TriEdge G = S;
+      if (G.tri->is_hulltri()) G = G.esym();
+      int loc;
+      set_vertex_metric(newvrt, G, loc);
+    }
   //}
   newvrt->idx = io_firstindex + (ct_in_vrts + tr_steiners->objects - 1);
   newvrt->tag = stag; //seg->tag;
@@ -272,7 +275,7 @@ int Triangulation::repair_encsegments(arraypool *encsegs, arraypool *enctris)
       if (pE->is_deleted()) continue;
       if (op_no_bisect == 0) { // no -Y option
         if (get_edge(pE->vrt[0], pE->vrt[1], E)) {
-          split_enc_segment(E, pE->vrt[2], fqueue, encsegs, enctris);
+          split_enc_segment(E, pE->vrt[2], true, fqueue, encsegs, enctris);
         }
       }
       pE->set_deleted();
@@ -289,7 +292,7 @@ int Triangulation::repair_encsegments(arraypool *encsegs, arraypool *enctris)
 //==============================================================================
 
 //void Triangulation::enq_triangle(Triang* tri, REAL cct[3], arraypool* enctris)
-void Triangulation::enq_triangle(Triang* tri, arraypool* enctris)
+void Triangulation::enq_triangle(Triang* tri, bool mtrflag, arraypool* enctris)
 {
   Triang *paryEle = (Triang *) enctris->alloc();
   paryEle->init(); // Initialize
@@ -346,21 +349,21 @@ int Triangulation::check_triangle(Triang *tri, arraypool* enctris)
   // (2) metric (mesh size) has priority than mesh quality
   if (op_maxarea > 0) {
     if (area > op_maxarea) {
-      enq_triangle(tri, enctris);
+      enq_triangle(tri, true, enctris);
       return 1;
     }
   }
 
   if (tri->val > 0) {
     if (area > tri->val) {
-      enq_triangle(tri, enctris);
+      enq_triangle(tri, true, enctris);
       return 1;
     }
   }
 
   if (op_target_length > 0) {
     if ((a > op_target_length) || (b > op_target_length) || (c > op_target_length)) {
-      enq_triangle(tri, enctris);
+      enq_triangle(tri, true, enctris);
       return 1;
     }
   }
@@ -368,19 +371,19 @@ int Triangulation::check_triangle(Triang *tri, arraypool* enctris)
   // Check mesh size at vertex.
   if (E.org()->val > 0) { // A
     if ((a > tri->vrt[0]->val) || (c > E.org()->val)) {
-      enq_triangle(tri, enctris);
+      enq_triangle(tri, true, enctris);
       return 1;
     }
   }
   if (E.dest()->val > 0) { // B
     if ((a > E.dest()->val) || (b > E.dest()->val)) {
-      enq_triangle(tri, enctris);
+      enq_triangle(tri, true, enctris);
       return 1;
     }
   }
   if (E.apex()->val > 0) { // C
     if ((c > E.apex()->val) || (b > E.apex()->val)) {
-      enq_triangle(tri, enctris);
+      enq_triangle(tri, true, enctris);
       return 1;
     }
   }
@@ -422,7 +425,7 @@ int Triangulation::check_triangle(Triang *tri, arraypool* enctris)
       TriEdge N1 = E;
       TriEdge N2 = E.eprev();
       if (!(N1.is_segment() && N2.is_segment())) {
-        enq_triangle(tri, enctris);
+        enq_triangle(tri, true, enctris);
         return 1;
       }
     }
@@ -560,7 +563,7 @@ int Triangulation::repair_triangles(arraypool *enctris)
         } else if (loc != LOC_IN_OUTSIDE) {          
           // Insert the vertex.
           assert(!E.tri->is_hulltri());
-          set_vertex_metric(newvrt, E); // interpolate mesh size for the new vertex.
+          set_vertex_metric(newvrt, E, loc); // interpolate mesh size for the new vertex.
           tt[0] = E;
           if (loc == LOC_IN_TRI) {
             int fflag = FLIP_13;
@@ -48,10 +48,10 @@ int Triangulation::get_boundary_cut_dualedge(Vertex& In_pt, Vertex& Out_pt, TriE
                  workedge.dest()->idx, workedge.apex()->idx);
         }
         assert(workedge.org() == S.org());
-        searchEdge = workedge.esym_enext(); // CW
+        searchEdge = workedge;
         if (searchEdge.is_segment()) break;
         if ((searchEdge.esym()).tri->is_hulltri()) break;
-        workedge = searchEdge;
+        workedge = searchEdge.esym_enext(); // CW
       }
       S = searchEdge.esym(); // Update S.
       s1 = Orient2d(&In_pt, &Out_pt, S.org());
@@ -86,6 +86,72 @@ int Triangulation::get_boundary_cut_dualedge(Vertex& In_pt, Vertex& Out_pt, TriE
   return 1;
 }
 
+//==============================================================================
+// Remove the skinny triangles at the convex hull by 2-2 flips, i.e., the ones
+//   whose angle at the hull edge is smaller than op_tol_min_minangle. Their
+//   orthocenters are far outside the domain.
+
+int Triangulation::remove_skinny_hulltris()
+{
+  if (op_db_verbose > 1) {
+    printf("  Removing skinny hull triangles.\n");
+  }
+
+  arraypool *queue = new arraypool(sizeof(TriEdge), 8);
+  TriEdge E, N, tt[4];
+  int i, count = 0;
+
+  for (i = 0; i < tr_tris->used_items; i++) {
+    Triang *tri = (Triang *) tr_tris->get(i);
+    if (tri->is_deleted()) continue;
+    if (!tri->is_hulltri()) continue;
+    E.tri = tri;
+    for (E.ver = 0; E.ver < 3; E.ver++) {
+      if (E.apex() == tr_infvrt) break;
+    }
+    * (TriEdge *) queue->alloc() = E;
+  }
+
+  for (i = 0; i < queue->used_items; i++) {
+    E = * (TriEdge *) queue->get(i);
+    if (E.is_segment()) continue;
+    N = E.esym();
+    if (N.apex() == tr_infvrt) continue;
+    REAL ang = get_angle(N.org(), N.dest(), N.apex());
+    if (op_db_verbose > 3) {
+      printf("      Check a hull triangle [%d,%d,%d], org_ang = %f degree.\n",
+             N.org()->idx, N.dest()->idx, N.apex()->idx, ang / PI * 180.);
+    }
+    if (ang >= op_tol_min_minangle) continue;
+    if (!(get_distance(N.org(), N.dest()) > get_distance(N.org(), N.apex()))) {
+      // The hull edge is not longer than the edge at the small angle, keep it.
+      if (op_db_verbose > 3) {
+        printf("      Skip a skinny hull triangle with a short hull edge.\n");
+      }
+      continue;
+    }
+    if (op_db_verbose > 3) {
+      printf("      Remove a skinny hull triangle.\n");
+    }
+    // The two hull edges after the flip.
+    TriEdge t1 = (N.enext()).esym();
+    TriEdge t2 = (N.eprev()).esym();
+    tt[0] = E;
+    int fflag = FLIP_22;
+    flip(tt, NULL, fflag, NULL);
+    * (TriEdge *) queue->alloc() = t1.esym();
+    * (TriEdge *) queue->alloc() = t2.esym();
+    count++;
+  }
+
+  if (op_db_verbose > 1) {
+    printf("  Removed %d skinny hull triangle.\n", count);
+  }
+
+  delete queue;
+  return 1;
+}
+
 //==============================================================================
 
 int Triangulation::get_hulltri_orthocenter(Triang* hulltri)
@@ -127,7 +193,7 @@ int Triangulation::get_hulltri_orthocenter(Triang* hulltri)
     // We move it along the edge normal towards exterior of the triangulaiton.
     TriEdge N = E.esym();
     // The dual vertex of N.tri was already calcualted.
-    assert(N.tri->on.tri != NULL); 
+    assert(N.tri->omt.tri != NULL); 
     if (op_db_verbose > 2) {
       printf("  Bisector on the hull edge:  [%g,%g]\n", E.tri->cct[0], E.tri->cct[1]);
       printf("  Ccenter of hull triangle N: [%g,%g]\n", N.tri->cct[0], N.tri->cct[1]);
@@ -184,16 +250,16 @@ int Triangulation::get_hulltri_orthocenter(Triang* hulltri)
         REAL Wy = N.apex()->crd[1];
         Mass_pt.crd[0] = (Ux + Vx + Wx) / 3.;
         Mass_pt.crd[1] = (Uy + Vy + Wy) / 3.;
-        TriEdge S = N.tri->on; // Must be an interior triangle of OMT_domain.
+        TriEdge S = N.tri->omt; // Must be an interior triangle of OMT_domain.
         int loc = OMT_domain->locate_point(&Mass_pt, S, 0, 0);
         */
         Vertex In_pt; // The bisector of this hull edge.
         In_pt.init();
         In_pt.crd[0] = E.tri->cct[0];
         In_pt.crd[1] = E.tri->cct[1];
-        TriEdge S = N.tri->on; // Must be an interior triangle of OMT_domain.
+        TriEdge S = N.tri->omt; // Must be an interior triangle of OMT_domain.
         if (op_db_verbose > 2) {
-          printf("  N.tri->on (cct) background tri: [%d,%d,%d]\n", S.org()->idx, S.dest()->idx, S.apex()->idx);
+          printf("  N.tri->omt (cct) background tri: [%d,%d,%d]\n", S.org()->idx, S.dest()->idx, S.apex()->idx);
         }
         //int loc = OMT_domain->locate_point(&In_pt, S, 0, 0);
         int loc = OMT_domain->locate_point(&In_pt, S, 0);
@@ -284,11 +350,11 @@ int Triangulation::get_hulltri_orthocenter(Triang* hulltri)
         }
         //===================== Subroutine end =================================
         */
-        E.tri->on = S; // Remember this triangle in OMT_domain.
+        E.tri->omt = S; // Remember this triangle in OMT_domain.
 
         // Calculate the cut point.
-        Vertex *e1 = E.tri->on.org();
-        Vertex *e2 = E.tri->on.dest();
+        Vertex *e1 = E.tri->omt.org();
+        Vertex *e2 = E.tri->omt.dest();
         double X0 = N.tri->cct[0];
         double Y0 = N.tri->cct[1];
         double X1 = Out_pt.crd[0];
@@ -328,7 +394,7 @@ int Triangulation::get_hulltri_orthocenter(Triang* hulltri)
       } // if (!N.is_segment()
       else {
         // [2019-07-28] Remember this boundary segment.
-        E.tri->on = N.esym();
+        E.tri->omt = N.esym();
       }
       // It is either on a segment or a hull edge of OMT_domain.
       E.tri->set_dual_on_bdry();
@@ -339,7 +405,7 @@ int Triangulation::get_hulltri_orthocenter(Triang* hulltri)
       E.tri->cct[0] = N.tri->cct[0] + len * outerN[0];
       E.tri->cct[1] = N.tri->cct[1] + len * outerN[1];
       E.tri->cct[2] = 0; // will be calulcated later.
-      E.tri->on = N.tri->on;
+      E.tri->omt = N.tri->omt;
       E.tri->set_dual_in_exterior();
     }
     if (op_db_verbose > 10) {
@@ -398,41 +464,41 @@ int Triangulation::get_tri_orthocenter(Triang* tri)
     pt.crd[1] = tri->cct[1];
     // First search the mass center of "tri" in OMT_domain.
     // It must be inside the domain.
-    //int loc = OMT_domain->locate_point(&Mass_pt, tri->on, 0, 0); // encflag = 0
-    int loc = OMT_domain->locate_point(&Mass_pt, tri->on, 0); // encflag = 0
-    assert(!tri->on.tri->is_hulltri()); 
+    //int loc = OMT_domain->locate_point(&Mass_pt, tri->omt, 0, 0); // encflag = 0
+    int loc = OMT_domain->locate_point(&Mass_pt, tri->omt, 0); // encflag = 0
+    assert(!tri->omt.tri->is_hulltri()); 
     // Locate the orthocenter of "tri" from this triangle (containing its mass center). 
-    //loc = OMT_domain->locate_point(&pt, tri->on, 0, 1); // encflag = 1 (stop at first segment).
-    loc = OMT_domain->locate_point(&pt, tri->on, 1); // encflag = 1 (stop at first segment).
+    //loc = OMT_domain->locate_point(&pt, tri->omt, 0, 1); // encflag = 1 (stop at first segment).
+    loc = OMT_domain->locate_point(&pt, tri->omt, 1); // encflag = 1 (stop at first segment).
     // Set the interior /exterior flag of the dual vertex.
     // Default, the dual (orothocenter) is in the interior.
     if (loc == LOC_IN_OUTSIDE) {
       tri->set_dual_in_exterior();
     } else if (loc == LOC_IN_TRI) {
-      if (tri->on.tri->is_exterior()) {
+      if (tri->omt.tri->is_exterior()) {
         tri->set_dual_in_exterior();
       }
     } else if (loc == LOC_ON_EDGE) {
-      if (tri->on.is_segment()) {
+      if (tri->omt.is_segment()) {
         tri->set_dual_on_bdry();
       }
     } else if (loc == LOC_ON_VERT) {
       // On a vertex of the background mesh, to be done.
-      TriEdge E = tri->on;
+      TriEdge E = tri->omt;
       do {
-        if (tri->on.tri->is_hulltri() || tri->on.tri->is_exterior()) {
+        if (tri->omt.tri->is_hulltri() || tri->omt.tri->is_exterior()) {
           tri->set_dual_in_exterior(); break;
-        } else if (tri->on.is_segment()) {
+        } else if (tri->omt.is_segment()) {
           tri->set_dual_on_bdry(); break;
         }
-        tri->on = tri->on.eprev_esym(); // CCW rotate
-        assert(tri->on.org() == E.org());
-      } while (E.tri != tri->on.tri);
+        tri->omt = tri->omt.eprev_esym(); // CCW rotate
+        assert(tri->omt.org() == E.org());
+      } while (E.tri != tri->omt.tri);
     } else if (loc == LOC_ENC_SEG) {
       // This dual vertex is behind a segment, which means it lies outside of the
       //   subdomain contains the triangle. We treat it as lying in outside.
       //   This way, a cut point on the segment will be calculated for Voronoi cells.
-      assert(tri->on.is_segment());
+      assert(tri->omt.is_segment());
       tri->set_dual_in_exterior();
     } 
   } // if (OMT_domain != NULL)
@@ -440,6 +506,178 @@ int Triangulation::get_tri_orthocenter(Triang* tri)
   return 1;
 }
 
+//==============================================================================
+// Find a point of the dual edge of mesh_edge which lies inside the OMT_domain,
+//   it is used when both dual vertices of this edge lie outside. The dual edge
+//   must cross mesh_edge, and the crossing point is returned in In_pt.
+
+int Triangulation::get_dual_edge_interior_point(TriEdge mesh_edge, Vertex *In_pt)
+{
+  TriEdge E = mesh_edge;
+  if ((E.org() == tr_infvrt) || (E.dest() == tr_infvrt)) {
+    return 0;
+  }
+  TriEdge N = E.esym();
+  if (E.tri->omt.tri == N.tri->omt.tri) {
+    return 0; // Both dual vertices are outside of the same boundary edge.
+  }
+
+  double X0 = E.tri->cct[0];
+  double Y0 = E.tri->cct[1];
+  double X1 = N.tri->cct[0];
+  double Y1 = N.tri->cct[1];
+  double t1 = 0, t2 = 0;
+  line_line_intersection(X0, Y0, X1, Y1, E.org()->crd[0], E.org()->crd[1],
+                         E.dest()->crd[0], E.dest()->crd[1], &t1, &t2);
+  if (!((t1 > 0) && (t1 < 1))) {
+    return 0;
+  }
+
+  In_pt->crd[0] = X0 + t1 * (X1 - X0);
+  In_pt->crd[1] = Y0 + t1 * (Y1 - Y0);
+
+  TriEdge S = E.tri->omt.esym();
+  int loc = OMT_domain->locate_point(In_pt, S, 1);
+  if ((loc == LOC_IN_OUTSIDE) || (loc == LOC_ENC_SEG)) {
+    return 0;
+  }
+
+  In_pt->on_omt = S;
+  return 1;
+}
+
+//==============================================================================
+// Cut the dual edge of mesh_edge at the boundary edge S of the OMT_domain.
+//   The two Voronoi vertices are ordered by the apexes of their triangles,
+//   so that both sides of a mesh edge give the same cut vertex. The weight of
+//   the cut vertex is with respect to mesh_edge.org(), see get_powercell().
+
+static int get_cut_vertex(TriEdge &mesh_edge, TriEdge &S, Vertex *cut_pt)
+{
+  TriEdge E = mesh_edge;
+  TriEdge N = E.esym();
+  if (E.apex()->idx < N.apex()->idx) {
+    TriEdge swapE = E; E = N; N = swapE;
+  }
+  Vertex *e1 = S.org();
+  Vertex *e2 = S.dest();
+  if (e1->idx >= e2->idx) {
+    Vertex *swappt = e1; e1 = e2; e2 = swappt;
+  }
+
+  double X0 = N.tri->cct[0];
+  double Y0 = N.tri->cct[1];
+  double X1 = E.tri->cct[0];
+  double Y1 = E.tri->cct[1];
+  double t1 = 0, t2 = 0;
+  if (!line_line_intersection(X0, Y0, X1, Y1, e1->crd[0], e1->crd[1],
+                              e2->crd[0], e2->crd[1], &t1, &t2)) {
+    return 0;
+  }
+
+  double c0 = X0 + t1 * (X1 - X0);
+  double c1 = Y0 + t1 * (Y1 - Y0);
+  // Calculate the weight
+  Vertex *mesh_vertex = mesh_edge.org();
+  double a = mesh_vertex->crd[0];
+  double b = mesh_vertex->crd[1];
+  double z_proj = 2.*a*c0+2.*b*c1 - (a*a+b*b) + mesh_vertex->wei;
+  cut_pt->crd[0] = c0;
+  cut_pt->crd[1] = c1;
+  cut_pt->crd[2] = c0*c0+c1*c1 - z_proj; // its weight
+  cut_pt->tag = -1; // A cut vertex.
+  return 1;
+}
+
+//==============================================================================
+// The dual edge of a mesh edge is the part of the segment between the
+//   orthocenters of its two triangles which lies inside the OMT_domain.
+//   Its endpoints are returned in dual_edge[0] and dual_edge[1], they are
+//   either Voronoi vertices (tag is the triangle index) or cut vertices (tag
+//   is -1). It assumes that the orthocenters are already calculated, see
+//   get_powercell(). pptlist and ptnum are not used.
+
+int Triangulation::get_dual_edge(TriEdge mesh_edge, Vertex *dual_edge, Vertex **pptlist, int *ptnum)
+{
+  TriEdge E = mesh_edge;
+  if ((E.org() == tr_infvrt) || (E.dest() == tr_infvrt)) {
+    return 0;
+  }
+  TriEdge N = E.esym();
+  if (op_db_verbose > 3) {
+    printf("  Get edge: [%d,%d] - [%d,%d].\n", E.org()->idx, E.dest()->idx,
+           E.apex()->idx, N.apex()->idx);
+  }
+
+  dual_edge[0].init();
+  dual_edge[1].init();
+
+  bool E_outside = E.tri->is_dual_in_exterior() || E.tri->is_dual_on_bdry();
+  bool N_outside = N.tri->is_dual_in_exterior() || N.tri->is_dual_on_bdry();
+  Vertex In_pt, Out_pt;
+  In_pt.init();
+  Out_pt.init();
+
+  if (E_outside && N_outside) {
+    // Both Voronoi vertices lie outside. The dual edge lies inside only if
+    //   it crosses mesh_edge inside the domain, cut it at both sides.
+    if (!get_dual_edge_interior_point(E, &In_pt)) {
+      return 0;
+    }
+    TriEdge S = N.tri->omt;
+    Out_pt.crd[0] = N.tri->cct[0];
+    Out_pt.crd[1] = N.tri->cct[1];
+    if (!get_boundary_cut_dualedge(In_pt, Out_pt, S)) {
+      return 0;
+    }
+    N.tri->omt = S; // Update N.tri->omt
+    get_cut_vertex(E, N.tri->omt, &(dual_edge[0]));
+
+    S = E.tri->omt;
+    Out_pt.crd[0] = E.tri->cct[0];
+    Out_pt.crd[1] = E.tri->cct[1];
+    if (!get_boundary_cut_dualedge(In_pt, Out_pt, S)) {
+      return 0;
+    }
+    E.tri->omt = S; // Update E.tri->omt
+    get_cut_vertex(E, E.tri->omt, &(dual_edge[1]));
+    return 1;
+  }
+
+  Triang *In_tri = E.tri; // The inside Voronoi vertex.
+  if (!E_outside && !N_outside) {
+    dual_edge[0].crd[0] = N.tri->cct[0];
+    dual_edge[0].crd[1] = N.tri->cct[1];
+    dual_edge[0].crd[2] = N.tri->cct[2];
+    dual_edge[0].tag = N.tri->idx;
+  } else {
+    // Cut the dual edge from the inside Voronoi vertex to the outside one.
+    Triang *Out_tri = N.tri;
+    if (E_outside) {
+      In_tri = N.tri;
+      Out_tri = E.tri;
+    }
+    In_pt.crd[0] = In_tri->cct[0];
+    In_pt.crd[1] = In_tri->cct[1];
+    Out_pt.crd[0] = Out_tri->cct[0];
+    Out_pt.crd[1] = Out_tri->cct[1];
+    TriEdge S = Out_tri->omt;
+    if (!get_boundary_cut_dualedge(In_pt, Out_pt, S)) {
+      return 0;
+    }
+    Out_tri->omt = S; // Update Out_tri->omt
+    if (!get_cut_vertex(E, Out_tri->omt, &(dual_edge[0]))) {
+      return 0;
+    }
+  }
+
+  dual_edge[1].crd[0] = In_tri->cct[0];
+  dual_edge[1].crd[1] = In_tri->cct[1];
+  dual_edge[1].crd[2] = In_tri->cct[2];
+  dual_edge[1].tag = In_tri->idx;
+  return 1;
+}
+
 //==============================================================================
 // The power cell of an interior mesh vertex is given by the convex hull of a
 //   set of corners, which are Voronoi vertices and cutting vertices (of Voronoi
@@ -578,7 +816,7 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
         // Calculating a cut vertex between this dual edge (from N.tri->cct to E.tri->cct)
         //    and a boundary edge (or a segment) S of the background mesh.
         //    We must ensure that the dual edge and S intersect in S's interior.
-        TriEdge S = E.tri->on;
+        TriEdge S = E.tri->omt;
         Vertex In_pt, Out_pt;
         In_pt.init();
         Out_pt.init();
@@ -595,11 +833,11 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
         }
 
         // Calculate the cut vertex, see Page 3, cut1.
-        E.tri->on = S; // Update E.tri->on
+        E.tri->omt = S; // Update E.tri->omt
         //printf("  Last Exit [%d,%d,%d]\n", S.org()->idx, S.dest()->idx, S.apex()->idx);
         
-        Vertex *e1 = E.tri->on.org();
-        Vertex *e2 = E.tri->on.dest();
+        Vertex *e1 = E.tri->omt.org();
+        Vertex *e2 = E.tri->omt.dest();
         //assert((e1 != NULL) && (e2 != NULL));
         double X0 = E.tri->cct[0];
         double Y0 = E.tri->cct[1];
@@ -634,7 +872,7 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
         }
 
         // Remember this (exit) boundary edge.
-        N_Last_Exit = E.tri->on;
+        N_Last_Exit = E.tri->omt;
         //printf("  2 Last Exit [%d,%d,%d]\n", N_Last_Exit.org()->idx,
         //       N_Last_Exit.dest()->idx, N_Last_Exit.apex()->idx);
       }
@@ -643,15 +881,15 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
         // We're walking from OUTSIDE to INSIDE.
         // (see Page 2, E.tri (p,-1,p2)'s cct is v3, N.tri (p,p1,-1)'s cct is v2.)
         assert(N_Last_Exit.tri != NULL);
-        // Since E's dual vertex lies exactly on boundary, then E.tri->on must contain this dual vertex.
+        // Since E's dual vertex lies exactly on boundary, then E.tri->omt must contain this dual vertex.
         //   This is guaranteed by the function get_hulltri_orthocenter().
         //   No need to call get_boundary_cut_dualedge().
         //printf("\n DBG start: \n");
         //printf("  N_Last_Exit: [%d,%d,%d]\n", N_Last_Exit.org()->idx, N_Last_Exit.dest()->idx, N_Last_Exit.apex()->idx);
-        //printf("  E.tri->on:   [%d,%d,%d]\n", E.tri->on.org()->idx, E.tri->on.dest()->idx, E.tri->on.apex()->idx);
+        //printf("  E.tri->omt:   [%d,%d,%d]\n", E.tri->omt.org()->idx, E.tri->omt.dest()->idx, E.tri->omt.apex()->idx);
         //printf("\n DBG end: \n");
-        if ((E.tri->on.tri != N_Last_Exit.tri) ||
-            ((E.tri->on.tri == N_Last_Exit.tri) && (E.tri->on.ver != N_Last_Exit.ver))) {
+        if ((E.tri->omt.tri != N_Last_Exit.tri) ||
+            ((E.tri->omt.tri == N_Last_Exit.tri) && (E.tri->omt.ver != N_Last_Exit.ver))) {
           // They are on different boundary edges.
           // (see Page 2, the bdry edges containing v2 and v3 are different.)
           // There might be corner vertices to be the vertices of this cell.
@@ -660,12 +898,13 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
           //   power cell. From startEdge to endEdge.
           TriEdge startEdge, endEdge, searchEdge;
           startEdge = N_Last_Exit.esym();
-          endEdge = E.tri->on.esym();
+          endEdge = E.tri->omt.esym();
           //===================== Subroutine start =================================
           // Start searching corner vertices from startEdge towards endEdge.
           // (see Page 2 for an example.)
           searchEdge = startEdge;
-          while (searchEdge.tri != endEdge.tri) {
+          while ((searchEdge.org() != endEdge.org()) ||
+                 (searchEdge.dest() != endEdge.dest())) {
             // Found a corner vertex.
             Vertex *pt = &(ptlist[ptcount]);
             pt->init();
@@ -681,11 +920,13 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
             ptcount++;
             // Go to the next boundary edge (around dest()).
             TriEdge workedge = searchEdge.enext();
+            if ((workedge.org() == endEdge.org()) &&
+                (workedge.dest() == endEdge.dest())) break;
             while (true) {
-              searchEdge = workedge.esym_enext(); // CW
+              searchEdge = workedge;
               if (searchEdge.is_segment()) break;
               if ((searchEdge.esym()).tri->is_hulltri()) break;
-              workedge = searchEdge;
+              workedge = searchEdge.esym_enext(); // CW
             }
             //if (searchEdge.is_segment()) {
             //  // hit a segment, we must stop.
@@ -704,7 +945,7 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
         // (see Page 2, E.tri (p,p1,-1)'s cct is v2, N.tri (p,p3,p1)'s cct is v1.)
         // Remeber this boundary edge.
         assert(N_Last_Exit.tri == NULL);
-        N_Last_Exit = E.tri->on; // (see Page 2, N_Last_Exit = startEdge.)
+        N_Last_Exit = E.tri->omt; // (see Page 2, N_Last_Exit = startEdge.)
         //printf("  2 Last Exit [%d,%d,%d]\n", N_Last_Exit.org()->idx,
         //       N_Last_Exit.dest()->idx, N_Last_Exit.apex()->idx);
         /*
@@ -753,7 +994,7 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
         // Calculating a cut vertex between this dual edge (from N.tri->cct to E.tri->cct)
         //    and a boundary edge (or a segment) S of the background mesh.
         //    We must ensure that the dual edge and S intersect in S's interior.
-        TriEdge S = N.tri->on;
+        TriEdge S = N.tri->omt;
         Vertex In_pt, Out_pt;
         In_pt.init();
         Out_pt.init();
@@ -767,25 +1008,26 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
           return 0;
         }
 
-        N.tri->on = S; // Update N.tri->on
+        N.tri->omt = S; // Update N.tri->omt
 
         //printf("\n DBG start: \n");
         //printf("  N_Last_Exit: [%d,%d,%d]\n", N_Last_Exit.org()->idx, N_Last_Exit.dest()->idx, N_Last_Exit.apex()->idx);
-        //printf("  N.tri->on:   [%d,%d,%d]\n", N.tri->on.org()->idx, N.tri->on.dest()->idx, N.tri->on.apex()->idx);
+        //printf("  N.tri->omt:   [%d,%d,%d]\n", N.tri->omt.org()->idx, N.tri->omt.dest()->idx, N.tri->omt.apex()->idx);
         //printf("\n DBG end: \n");
-        if ((N.tri->on.tri != N_Last_Exit.tri) ||
-            ((N.tri->on.tri == N_Last_Exit.tri) && (N.tri->on.ver != N_Last_Exit.ver))) {
+        if ((N.tri->omt.tri != N_Last_Exit.tri) ||
+            ((N.tri->omt.tri == N_Last_Exit.tri) && (N.tri->omt.ver != N_Last_Exit.ver))) {
           // They are on different boundary.
           // There might be corner vertices to be the vertices of this cell.
           //printf("  !!! Searching background corners (2) DEBUG!!!\n");
           // (see Page 2 for an example.)
           TriEdge startEdge, endEdge, searchEdge;
           startEdge = N_Last_Exit.esym();
-          endEdge = N.tri->on.esym();
+          endEdge = N.tri->omt.esym();
           //===================== Subroutine start =================================
           // Start searching corner vertices from startEdge towards endEdge.
           searchEdge = startEdge;
-          while (searchEdge.tri != endEdge.tri) {
+          while ((searchEdge.org() != endEdge.org()) ||
+                 (searchEdge.dest() != endEdge.dest())) {
             // Found a corner vertex.
             Vertex *pt = &(ptlist[ptcount]);
             pt->init();
@@ -801,11 +1043,13 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
             ptcount++;
             // Go to the next boundary edge (around dest()).
             TriEdge workedge = searchEdge.enext();
+            if ((workedge.org() == endEdge.org()) &&
+                (workedge.dest() == endEdge.dest())) break;
             while (true) {
-              searchEdge = workedge.esym_enext(); // CW
+              searchEdge = workedge;
               if (searchEdge.is_segment()) break;
               if ((searchEdge.esym()).tri->is_hulltri()) break;
-              workedge = searchEdge;
+              workedge = searchEdge.esym_enext(); // CW
             }
             //if (searchEdge.is_segment()) {
             //  // to do ...
@@ -816,8 +1060,8 @@ int Triangulation::get_powercell(Vertex *mesh_vertex, Vertex** pptlist, int* ptn
         }
 
         // Calculate the cut2 vertex (see Page 3, cut2)
-        Vertex *e1 = N.tri->on.org();
-        Vertex *e2 = N.tri->on.dest();
+        Vertex *e1 = N.tri->omt.org();
+        Vertex *e2 = N.tri->omt.dest();
         assert((e1 != NULL) && (e2 != NULL));
         double X0 = E.tri->cct[0];
         double Y0 = E.tri->cct[1];
@@ -920,7 +1164,7 @@ int Triangulation::get_mass_center(Vertex* ptlist, int ptnum, REAL mc[2])
 
 //==============================================================================
 
-void Triangulation::save_voronoi()
+void Triangulation::save_voronoi(int ucd)
 {
   // We need a background grid to cut the exterior Voronoi cells.
   bool clean_omt_domain = false;
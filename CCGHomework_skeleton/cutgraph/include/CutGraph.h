@@ -1,6 +1,8 @@
 #ifndef _CUT_GRAPH_H_
 #define _CUT_GRAPH_H_
 
+#include <vector>
+
 #include "CutGraphMesh.h"
 
 namespace MeshLib
@@ -28,21 +30,81 @@ class CCutGraph
      */
     void cut_graph();
 
+    /*!
+     * Compute the cut graph made of the greedy shortest homology generators:
+     * the shortest path tree of the vertices from the root, and the maximum
+     * spanning tree of the dual edges weighted by the length of the loop
+     * through each edge. Each remaining edge closes one generator.
+     * \param pRoot root vertex, the first vertex if NULL
+     */
+    void greedy_cut_graph(CCutGraphVertex *pRoot = NULL);
+
   protected:
     /*!
      *  Input closed mesh.
      */
     CCutGraphMesh *m_pMesh;
 
+    /*!
+     *  Index the vertices and edges, and build the flat vertex-edge adjacency.
+     */
+    void _index();
+
     /*!
      *  Compute the spanning tree of the dual mesh.
      */
     void _dual_spanning_tree();
 
     /*!
-     * Prune the branches which attached to valence-1 nodes.
+     *  Dijkstra shortest path tree of the vertices from the root, with a binary heap.
+     */
+    void _shortest_path_tree(int root);
+
+    /*!
+     *  Maximum spanning tree of the dual mesh through the edges not in the
+     *  shortest path tree, weighted by the length of the loop through the edge.
+     */
+    void _maximum_dual_spanning_tree();
+
+    /*!
+     * Prune the branches which attached to valence-1 nodes, in one pass
+     * driven by a queue of valence-1 vertices, until only loops remain.
+     */
+    void _prune();
+
+    /*!
+     *  Edge flags shared by the steps, true for the dual spanning tree,
+     *  then true for the cut graph.
+     */
+    std::vector<bool> m_edge_flag;
+
+    /*!
+     *  The two vertex indices of each edge.
+     */
+    std::vector<int> m_edge_vertex;
+
+    /*!
+     *  Edges around each vertex, the edges of vertex v are
+     *  m_vertex_edge[m_vertex_offset[v]] to m_vertex_edge[m_vertex_offset[v + 1] - 1].
+     */
+    std::vector<int> m_vertex_offset;
+    std::vector<int> m_vertex_edge;
+
+    /*!
+     *  The two face indices of each edge, -1 on the boundary.
+     */
+    std::vector<int> m_edge_face;
+
+    /*!
+     *  Edge lengths.
+     */
+    std::vector<double> m_edge_length;
+
+    /*!
+     *  Distances from the root, and the edges of the shortest path tree.
      */
-    bool _prune();
+    std::vector<double> m_distance;
+    std::vector<bool> m_primal_tree;
 };
 } // namespace MeshLib
 #endif // !_CUT_GRAPH_H_
@@ -27,7 +27,7 @@ class CCutGraphVertex : public CVertex
 {
   public:
     /*! Constructor */
-    CCutGraphVertex() : m_valence(0){};
+    CCutGraphVertex() : m_valence(0), m_index(0){};
 
     /*! Vertex valence */
     int &valence()
@@ -35,9 +35,18 @@ class CCutGraphVertex : public CVertex
         return m_valence;
     };
 
+    /*! Vertex index */
+    int &idx()
+    {
+        return m_index;
+    };
+
   protected:
     /*! Vertex valence */
     int m_valence;
+
+    /*! Vertex index */
+    int m_index;
 };
 
 /*! \brief CCutGraphEdge class
@@ -49,7 +58,7 @@ class CCutGraphEdge : public CEdge
 {
   public:
     /*! Constructor */
-    CCutGraphEdge() : m_sharp(false){};
+    CCutGraphEdge() : m_sharp(false), m_index(0){};
 
     /*! Sharp edge */
     bool &sharp()
@@ -57,9 +66,18 @@ class CCutGraphEdge : public CEdge
         return m_sharp;
     };
 
+    /*! Edge index */
+    int &idx()
+    {
+        return m_index;
+    };
+
   protected:
     /*! Sharp edge */
     bool m_sharp;
+
+    /*! Edge index */
+    int m_index;
 };
 
 /*! \brief CCutGraphFace class
@@ -71,7 +89,7 @@ class CCutGraphFace : public CFace
 {
   public:
     /*! Constructor */
-    CCutGraphFace() : m_touched(false){};
+    CCutGraphFace() : m_touched(false), m_index(0){};
 
     /*! face touched flag */
     bool &touched()
@@ -79,6 +97,12 @@ class CCutGraphFace : public CFace
         return m_touched;
     };
 
+    /*! Face index */
+    int &idx()
+    {
+        return m_index;
+    };
+
     /*! face normal */
     CPoint &normal()
     {
@@ -89,6 +113,9 @@ class CCutGraphFace : public CFace
     /*! face touched flag */
     bool m_touched;
 
+    /*! Face index */
+    int m_index;
+
     /*! face normal */
     CPoint m_normal;
 };
@@ -1,26 +1,110 @@
 #include "CutGraph.h"
 #include "CutGraphMesh.h"
+#include "Mesh/GraphPruner.h"
+#include <functional>
+#include <limits>
 #include <queue>
+#include <utility>
 
 void MeshLib::CCutGraph::cut_graph()
 {
+    _index();
     _dual_spanning_tree();
 
     // The cut graph contains all edges which their duals are not
     // in the spanning tree.
+    m_edge_flag.flip();
+
+    _prune();
+
     for (CCutGraphMesh::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
     {
         CCutGraphEdge *pE = *eiter;
-        pE->sharp() = !pE->sharp();
+        pE->sharp() = m_edge_flag[pE->idx()];
     }
+}
+
+void MeshLib::CCutGraph::greedy_cut_graph(CCutGraphVertex *pRoot)
+{
+    _index();
+    _shortest_path_tree(pRoot ? pRoot->idx() : 0);
+    _maximum_dual_spanning_tree();
 
-    bool edgeRemoved = true;
-    while (edgeRemoved)
+    // The cut graph contains all edges which their duals are not
+    // in the spanning tree, the branches of the shortest path tree
+    // off the generators are pruned.
+    m_edge_flag.flip();
+
+    _prune();
+
+    for (CCutGraphMesh::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
     {
-        edgeRemoved = _prune();
+        CCutGraphEdge *pE = *eiter;
+        pE->sharp() = m_edge_flag[pE->idx()];
     }
 }
 
+void MeshLib::CCutGraph::_index()
+{
+    int id = 0;
+    for (CCutGraphMesh::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    {
+        CCutGraphVertex *pV = *viter;
+        pV->idx() = id++;
+    }
+
+    const int nv = id;
+    m_vertex_offset.assign(nv + 1, 0);
+    m_edge_vertex.clear();
+    m_edge_vertex.reserve(2 * m_pMesh->numEdges());
+    m_edge_face.clear();
+    m_edge_face.reserve(2 * m_pMesh->numEdges());
+    m_edge_length.clear();
+    m_edge_length.reserve(m_pMesh->numEdges());
+
+    id = 0;
+    for (CCutGraphMesh::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        CCutGraphFace *pF = *fiter;
+        pF->idx() = id++;
+    }
+
+    id = 0;
+    for (CCutGraphMesh::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
+    {
+        CCutGraphEdge *pE = *eiter;
+        pE->idx() = id++;
+
+        int v1 = m_pMesh->edgeVertex1(pE)->idx();
+        int v2 = m_pMesh->edgeVertex2(pE)->idx();
+        m_edge_vertex.push_back(v1);
+        m_edge_vertex.push_back(v2);
+        m_edge_length.push_back((m_pMesh->edgeVertex1(pE)->point() - m_pMesh->edgeVertex2(pE)->point()).norm());
+
+        for (int k = 0; k < 2; k++)
+        {
+            CCutGraphHalfEdge *pH = m_pMesh->edgeHalfedge(pE, k);
+            m_edge_face.push_back(pH ? m_pMesh->halfedgeFace(pH)->idx() : -1);
+        }
+        m_vertex_offset[v1 + 1]++;
+        m_vertex_offset[v2 + 1]++;
+    }
+
+    const int ne = id;
+    for (int v = 0; v < nv; v++)
+        m_vertex_offset[v + 1] += m_vertex_offset[v];
+
+    std::vector<int> next(m_vertex_offset.begin(), m_vertex_offset.end() - 1);
+    m_vertex_edge.resize(2 * ne);
+    for (int e = 0; e < ne; e++)
+    {
+        m_vertex_edge[next[m_edge_vertex[2 * e]]++] = e;
+        m_vertex_edge[next[m_edge_vertex[2 * e + 1]]++] = e;
+    }
+
+    m_edge_flag.assign(ne, false);
+}
+
 /*----------------------------------------------------------------------------
 
 Modify the method CCutGraph::_dual_spanning_tree()
@@ -29,12 +113,8 @@ Modify the method CCutGraph::_dual_spanning_tree()
 
 void MeshLib::CCutGraph::_dual_spanning_tree()
 {
-    // Mark all sharp flags false
-    for (CCutGraphMesh::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
-    {
-        CCutGraphEdge *pE = *eiter;
-        pE->sharp() = false;
-    }
+    // Mark all edge flags false
+    m_edge_flag.assign(m_edge_flag.size(), false);
 
     // Mark all touched flags false, and select a face
     CCutGraphFace *pHeadFace = NULL;
@@ -68,7 +148,7 @@ void MeshLib::CCutGraph::_dual_spanning_tree()
                 {
                     pSymFace->touched() = true;
                     CCutGraphEdge *pE = m_pMesh->halfedgeEdge(pH);
-                    pE->sharp() = true;
+                    m_edge_flag[pE->idx()] = true;
                     fQueue.push(pSymFace);
                 }
             }
@@ -76,59 +156,114 @@ void MeshLib::CCutGraph::_dual_spanning_tree()
     }
 }
 
-/*----------------------------------------------------------------------------
-
-Modify the method _CCutGraph::_prune()
+void MeshLib::CCutGraph::_shortest_path_tree(int root)
+{
+    typedef std::pair<double, int> CHeapEntry;
 
-------------------------------------------------------------------------------*/
+    const int nv = (int)m_vertex_offset.size() - 1;
 
-bool MeshLib::CCutGraph::_prune()
-{
-    bool edgeRemoved = false;
+    m_distance.assign(nv, std::numeric_limits<double>::max());
+    m_primal_tree.assign(m_edge_length.size(), false);
+    std::vector<int> parent(nv, -1);
+    std::vector<bool> done(nv, false);
 
-    // A queue used to store valence-1 vertices
-    std::queue<CCutGraphVertex *> vQueue;
+    // binary min-heap, outdated entries are skipped when popped
+    std::priority_queue<CHeapEntry, std::vector<CHeapEntry>, std::greater<CHeapEntry>> heap;
+    m_distance[root] = 0;
+    heap.push(CHeapEntry(0, root));
 
-    // 1. Compute the valence of each vertex, and record all valence-1 vertices.
-    for (CCutGraphMesh::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    while (!heap.empty())
     {
-        CCutGraphVertex *pV = *viter;
-        pV->valence() = 0;
+        int v = heap.top().second;
+        heap.pop();
+        if (done[v])
+            continue;
+        done[v] = true;
+        if (parent[v] >= 0)
+            m_primal_tree[parent[v]] = true;
 
-        for (CCutGraphMesh::VertexEdgeIterator_ veiter(pV); !veiter.end(); ++veiter)
+        for (int k = m_vertex_offset[v]; k < m_vertex_offset[v + 1]; k++)
         {
-            CCutGraphEdge *pE = *veiter;
-            if (pE->sharp())
+            int e = m_vertex_edge[k];
+            int w = (m_edge_vertex[2 * e] == v) ? m_edge_vertex[2 * e + 1] : m_edge_vertex[2 * e];
+            double d = m_distance[v] + m_edge_length[e];
+            if (!done[w] && d < m_distance[w])
             {
-                pV->valence()++;
+                m_distance[w] = d;
+                parent[w] = e;
+                heap.push(CHeapEntry(d, w));
             }
         }
-
-        if (pV->valence() == 1)
-        {
-            vQueue.push(pV);
-            if (!edgeRemoved)
-                edgeRemoved = true;
-        }
     }
+}
+
+void MeshLib::CCutGraph::_maximum_dual_spanning_tree()
+{
+    typedef std::pair<double, int> CHeapEntry;
+
+    const int ne = (int)m_edge_length.size();
+    const int nf = m_pMesh->numFaces();
+
+    m_edge_flag.assign(ne, false);
+    std::vector<bool> touched(nf, false);
 
-    // 2. Remove the segments which attached to valence-1 vertices.
-    while (!vQueue.empty())
+    // faces of each dual edge, through the edges not in the shortest path tree
+    std::vector<std::vector<int>> face_edges(nf);
+    for (int e = 0; e < ne; e++)
     {
-        CCutGraphVertex *pV = vQueue.front();
-        vQueue.pop();
+        if (m_primal_tree[e] || m_edge_face[2 * e] < 0 || m_edge_face[2 * e + 1] < 0)
+            continue;
+        face_edges[m_edge_face[2 * e]].push_back(e);
+        face_edges[m_edge_face[2 * e + 1]].push_back(e);
+    }
 
-        for (CCutGraphMesh::VertexEdgeIterator_ veiter(pV); !veiter.end(); ++veiter)
+    // Prim, binary max-heap of the loop lengths of the edges leaving the tree
+    std::priority_queue<CHeapEntry> heap;
+    auto visit = [&](int f) {
+        touched[f] = true;
+        for (size_t k = 0; k < face_edges[f].size(); k++)
         {
-            CCutGraphEdge *pE = *veiter;
-            CCutGraphVertex *pW = m_pMesh->edgeVertex1(pE) == pV ? m_pMesh->edgeVertex2(pE) : m_pMesh->edgeVertex1(pE);
-            if (pE->sharp())
-            {
-                pE->sharp() = false;
-                break;
-            }
+            int e = face_edges[f][k];
+            int g = (m_edge_face[2 * e] == f) ? m_edge_face[2 * e + 1] : m_edge_face[2 * e];
+            if (touched[g])
+                continue;
+            double loop = m_distance[m_edge_vertex[2 * e]] + m_distance[m_edge_vertex[2 * e + 1]] + m_edge_length[e];
+            heap.push(CHeapEntry(loop, e));
         }
+    };
+
+    visit(0);
+    while (!heap.empty())
+    {
+        int e = heap.top().second;
+        heap.pop();
+
+        int f = m_edge_face[2 * e];
+        int g = m_edge_face[2 * e + 1];
+        if (touched[f] && touched[g])
+            continue;
+
+        m_edge_flag[e] = true;
+        visit(touched[f] ? g : f);
     }
+}
+
+/*----------------------------------------------------------------------------
+
+Modify the method _CCutGraph::_prune()
 
-    return edgeRemoved;
+------------------------------------------------------------------------------*/
+
+void MeshLib::CCutGraph::_prune()
+{
+    const int nv = (int)m_vertex_offset.size() - 1;
+
+    std::vector<int> valence;
+    prune_graph(nv, m_vertex_offset.data(), m_vertex_edge.data(), m_edge_vertex.data(), m_edge_flag, valence);
+
+    for (CCutGraphMesh::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    {
+        CCutGraphVertex *pV = *viter;
+        pV->valence() = valence[pV->idx()];
+    }
 }
@@ -26,6 +26,11 @@ CArcball g_arcball;
 /* global g_mesh */
 CCutGraphMesh g_mesh;
 
+/* greedy shortest generators, or the breadth first cut graph */
+bool g_greedy = true;
+
+void cut_graph(CCutGraphMesh *pMesh);
+
 /*! setup the object, transform from the world to the object coordinate system
  */
 void setupObject(void)
@@ -157,6 +162,7 @@ void help()
     printf("w  -  Wireframe Display\n");
     printf("f  -  Flat Shading \n");
     printf("s  -  Smooth Shading\n");
+    printf("g  -  Greedy shortest or breadth first cut graph\n");
     printf("?  -  Help Information\n");
     printf("esc - quit\n");
 }
@@ -180,6 +186,11 @@ void keyBoard(unsigned char key, int x, int y)
         // Wireframe mode
         glPolygonMode(GL_FRONT, GL_LINE);
         break;
+    case 'g':
+        // switch the cut graph
+        g_greedy = !g_greedy;
+        cut_graph(&g_mesh);
+        break;
     case '?':
         help();
         break;
@@ -392,7 +403,10 @@ void initOpenGL(int argc, char *argv[])
 void cut_graph(CCutGraphMesh *pMesh)
 {
     CCutGraph cg(pMesh);
-    cg.cut_graph();
+    if (g_greedy)
+        cg.greedy_cut_graph();
+    else
+        cg.cut_graph();
 }
 
 /*! main function for viewer
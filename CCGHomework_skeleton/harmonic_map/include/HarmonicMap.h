@@ -2,6 +2,7 @@
 #define _HARMONIC_MAP_H_
 
 #include "HarmonicMapMesh.h"
+#include "Mesh/MeshHierarchy.h"
 
 namespace MeshLib
 {
@@ -42,6 +43,15 @@ class CHarmonicMap
      */
     void map();
 
+    /*!
+     *  Coarse to fine harmonic map, the coarsest level is solved directly,
+     *  each finer level starts from the prolongated map of the coarser one
+     *  and is refined by the iterative method
+     *  \param hierarchy hierarchy built from the current mesh
+     *  \param epsilon error threshold
+     */
+    void multires_map(CMeshHierarchy<CHarmonicMapMesh> &hierarchy, double epsilon = 1e-5);
+
   protected:
     /*!
      *  Compute edge weight
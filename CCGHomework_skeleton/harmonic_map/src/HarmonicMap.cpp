@@ -207,6 +207,62 @@ void MeshLib::CHarmonicMap::map()
     }
 }
 
+void MeshLib::CHarmonicMap::multires_map(CMeshHierarchy<CHarmonicMapMesh> &hierarchy, double epsilon)
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
+    }
+
+    using M = CHarmonicMapMesh;
+
+    // images of all vertices, indexed by the hierarchy, the boundary is
+    // shared by all levels and keeps the parameterization of the input mesh
+    std::vector<CPoint2> uv(hierarchy.numVertices(0));
+    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex *pV = *viter;
+        if (pV->boundary())
+            uv[hierarchy.index(pV->id())] = pV->uv();
+    }
+
+    const int coarsest = hierarchy.levels() - 1;
+    for (int level = coarsest; level >= 0; --level)
+    {
+        // the finest level is the current mesh, coarser ones get their own mapper
+        CHarmonicMap coarse;
+        CHarmonicMap &mapper = (level == 0) ? *this : coarse;
+        M *pMesh = (level == 0) ? m_pMesh : hierarchy.mesh(level);
+        if (level > 0)
+            coarse.set_mesh(pMesh);
+
+        if (level < coarsest)
+            hierarchy.prolong(level + 1, uv);
+        for (M::MeshVertexIterator_ viter(pMesh); !viter.end(); ++viter)
+        {
+            M::CVertex *pV = *viter;
+            if (pV->boundary() || level < coarsest)
+                pV->uv() = uv[hierarchy.index(pV->id())];
+        }
+
+        std::cout << "Level " << level << ", " << pMesh->numVertices() << " vertices" << std::endl;
+        if (level == coarsest)
+            mapper.map();
+        else
+            mapper.iterative_map(epsilon);
+
+        for (M::MeshVertexIterator_ viter(pMesh); !viter.end(); ++viter)
+        {
+            M::CVertex *pV = *viter;
+            uv[hierarchy.index(pV->id())] = pV->uv();
+        }
+
+        if (level > 0)
+            delete pMesh;
+    }
+}
+
 void MeshLib::CHarmonicMap::_calculate_edge_weight()
 {
     using M = CHarmonicMapMesh;
@@ -230,7 +286,6 @@ void MeshLib::CHarmonicMap::_calculate_edge_weight()
         for (M::FaceHalfedgeIterator_ fhiter(pF); !fhiter.end(); ++fhiter, i++)
         {
             pH[i] = *fhiter;
-            M::CEdge *pE = dynamic_cast<M::CEdge *>(pH[i]->edge()); // HACK: cast edge to the right type
         }
 
         auto getLength = [=](int i) { return m_pMesh->halfedgeEdge(pH[i])->length(); };
@@ -1,4 +1,5 @@
 #include <math.h>
+#include <memory>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -35,6 +36,11 @@ CArcball g_arcball;
 CHarmonicMapMesh g_mesh;
 CHarmonicMap g_mapper;
 
+/* multiresolution hierarchy, built on first use and cached in a file,
+   declared after g_mesh so that it is destroyed first at exit */
+std::unique_ptr<CMeshHierarchy<CHarmonicMapMesh>> g_hierarchy;
+std::string g_hierarchy_name;
+
 /*! setup the object, transform from the world to the object coordinate system */
 void setupObject(void)
 {
@@ -182,6 +188,7 @@ void help()
     printf("n  -  Take next one step of iterative method\n");
     printf("i  -  Iterative method of harmonic map\n");
     printf("h  -  Directly solve the equations\n");
+    printf("m  -  Coarse to fine harmonic map\n");
     printf("w  -  Wireframe Display\n");
     printf("f  -  Flat Shading \n");
     printf("s  -  Smooth Shading\n");
@@ -214,6 +221,19 @@ void keyBoard(unsigned char key, int x, int y)
         // directly solve the equations
         g_mapper.map();
         break;
+    case 'm':
+        // coarse to fine harmonic map
+        if (!g_hierarchy)
+        {
+            g_hierarchy.reset(new CMeshHierarchy<CHarmonicMapMesh>(&g_mesh));
+            if (!g_hierarchy->read(g_hierarchy_name.c_str()))
+            {
+                g_hierarchy->build();
+                g_hierarchy->write(g_hierarchy_name.c_str());
+            }
+        }
+        g_mapper.multires_map(*g_hierarchy);
+        break;
     case 'f':
         // Flat Shading
         glPolygonMode(GL_FRONT, GL_FILL);
@@ -462,6 +482,7 @@ int main(int argc, char *argv[])
     computeNormal(&g_mesh);
 
     g_mapper.set_mesh(&g_mesh);
+    g_hierarchy_name = mesh_name + ".hier";
 
     initOpenGL(argc, argv);
     return EXIT_SUCCESS;
@@ -0,0 +1,413 @@
+/*!
+ *  \file DiscreteExteriorCalculus.h
+ *  \brief Discrete exterior calculus operators as sparse matrices
+ *
+ *  The exterior derivatives d0, d1 are incidence matrices stored as CSR,
+ *  the Hodge stars are diagonal. 0-, 1- and 2-forms are dense vectors
+ *  indexed by vertex, edge and face idx(). A 1-form value is the value on
+ *  the first halfedge of the edge, the second halfedge carries its negative.
+ */
+
+#ifndef _DISCRETE_EXTERIOR_CALCULUS_H_
+#define _DISCRETE_EXTERIOR_CALCULUS_H_
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "Geometry/Point.h"
+
+namespace MeshLib
+{
+
+/*! \brief CDiscreteExteriorCalculus class
+ *
+ *  Builds d0, d1 and the diagonal Hodge stars of a triangle mesh once.
+ *  The constructor (re)assigns idx() of the vertices, edges and faces
+ *  in the order of the mesh iterators.
+ *  \tparam M mesh class, whose vertex, edge and face classes have idx()
+ */
+template <typename M> class CDiscreteExteriorCalculus
+{
+  public:
+    typedef Eigen::SparseMatrix<double, Eigen::RowMajor> CSRMatrix;
+
+    /*!
+     *  CDiscreteExteriorCalculus constructor
+     *  \param pMesh input mesh
+     */
+    CDiscreteExteriorCalculus(M *pMesh);
+
+    /*! number of vertices, edges and faces */
+    int numVertices()
+    {
+        return m_nv;
+    };
+    int numEdges()
+    {
+        return m_ne;
+    };
+    int numFaces()
+    {
+        return m_nf;
+    };
+
+    /*! exterior derivative on 0-forms, #E x #V */
+    CSRMatrix &d0()
+    {
+        return m_d0;
+    };
+
+    /*! exterior derivative on 1-forms, #F x #E */
+    CSRMatrix &d1()
+    {
+        return m_d1;
+    };
+
+    /*! d0^T star1, #V x #E, the weak divergence of 1-forms on the vertices */
+    CSRMatrix &divergence()
+    {
+        return m_div;
+    };
+
+    /*! Hodge star on 0-forms, barycentric dual areas */
+    Eigen::VectorXd &star0()
+    {
+        return m_star0;
+    };
+
+    /*! Hodge star on 1-forms, (cot alpha + cot beta) / 2 */
+    Eigen::VectorXd &star1()
+    {
+        return m_star1;
+    };
+
+    /*! Hodge star on 2-forms, inverse face areas */
+    Eigen::VectorXd &star2()
+    {
+        return m_star2;
+    };
+
+    /*! true for the boundary edges */
+    std::vector<bool> &boundary_edges()
+    {
+        return m_boundary_edge;
+    };
+
+    /*! true for the boundary vertices */
+    std::vector<bool> &boundary_vertices()
+    {
+        return m_boundary_vertex;
+    };
+
+    /*! codifferential on 1-forms, star0^-1 d0^T star1 */
+    Eigen::VectorXd delta1(const Eigen::VectorXd &omega)
+    {
+        return (m_d0.transpose() * m_star1.cwiseProduct(omega)).cwiseQuotient(m_star0);
+    };
+
+    /*! codifferential on 2-forms, star1^-1 d1^T star2 */
+    Eigen::VectorXd delta2(const Eigen::VectorXd &sigma)
+    {
+        return (m_d1.transpose() * m_star2.cwiseProduct(sigma)).cwiseQuotient(m_star1);
+    };
+
+    /*!
+     *  L2 inner product of two 1-forms
+     *  \return \f$ \int \omega_0 \wedge {}^*\omega_1 \f$
+     */
+    double wedge_star_product(const Eigen::VectorXd &omega0, const Eigen::VectorXd &omega1)
+    {
+        return omega0.dot(m_star1.cwiseProduct(omega1));
+    };
+
+    /*!
+     *  Wedge product of two 1-forms
+     *  \return \f$ \int \omega_0 \wedge \omega_1 \f$
+     */
+    double wedge_product(const Eigen::VectorXd &omega0, const Eigen::VectorXd &omega1);
+
+    /*!
+     *  Wedge and wedge-star products of all pairs of 1-forms, the faces are
+     *  visited once and each thread accumulates its own partial Gram matrix
+     *  \param omega 1-forms, one per column
+     *  \param W \f$ W_{ij} = \int \omega_i \wedge \omega_j \f$
+     *  \param S \f$ S_{ij} = \int \omega_i \wedge {}^*\omega_j \f$
+     */
+    void wedge_gram(const Eigen::MatrixXd &omega, Eigen::MatrixXd &W, Eigen::MatrixXd &S);
+
+    /*! read the 1-form on the first halfedges of a mesh with the same connectivity */
+    void get_halfedge_form(M *pForm, Eigen::VectorXd &omega);
+
+    /*! write a 1-form to the halfedges of a mesh with the same connectivity */
+    void set_halfedge_form(M *pForm, const Eigen::VectorXd &omega);
+
+    /*! read the 1-form du() of a mesh with the same connectivity */
+    void get_du(M *pForm, Eigen::VectorXd &omega);
+
+    /*! write the 1-form du() of a mesh with the same connectivity */
+    void set_du(M *pForm, const Eigen::VectorXd &omega);
+
+    /*! write a complex 1-form duv() of a mesh with the same connectivity */
+    void set_duv(M *pForm, const Eigen::VectorXd &omega, const Eigen::VectorXd &conjugate);
+
+  protected:
+    /*! edges of pForm in the edge order of the mesh */
+    void _match_edges(M *pForm, std::vector<typename M::CEdge *> &edges);
+
+  protected:
+    /*! input mesh */
+    M *m_pMesh;
+    /*! number of vertices, edges and faces */
+    int m_nv, m_ne, m_nf;
+    /*! exterior derivatives */
+    CSRMatrix m_d0, m_d1;
+    /*! d0^T star1 */
+    CSRMatrix m_div;
+    /*! diagonal Hodge stars */
+    Eigen::VectorXd m_star0, m_star1, m_star2;
+    /*! ids of the source and target of each edge, to match edges of other meshes */
+    std::vector<int> m_edge_ids;
+    /*! edges of the faces in halfedge order, with the orientation signs */
+    std::vector<int> m_face_edge;
+    std::vector<double> m_face_sign;
+    /*! boundary flags */
+    std::vector<bool> m_boundary_edge;
+    std::vector<bool> m_boundary_vertex;
+};
+
+template <typename M> CDiscreteExteriorCalculus<M>::CDiscreteExteriorCalculus(M *pMesh) : m_pMesh(pMesh)
+{
+    // 1. index all the cells
+    m_nv = 0;
+    for (typename M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    {
+        typename M::CVertex *pV = *viter;
+        pV->idx() = m_nv++;
+        m_boundary_vertex.push_back(pV->boundary());
+    }
+    m_ne = 0;
+    for (typename M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
+    {
+        typename M::CEdge *pE = *eiter;
+        pE->idx() = m_ne++;
+        m_edge_ids.push_back(m_pMesh->edgeVertex1(pE)->id());
+        m_edge_ids.push_back(m_pMesh->edgeVertex2(pE)->id());
+        m_boundary_edge.push_back(m_pMesh->edgeHalfedge(pE, 1) == NULL);
+    }
+    m_nf = 0;
+    for (typename M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        (*fiter)->idx() = m_nf++;
+    }
+
+    // 2. d0, the first halfedge of an edge points from its source to its target
+    std::vector<Eigen::Triplet<double>> coefficients;
+    for (typename M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
+    {
+        typename M::CEdge *pE = *eiter;
+        typename M::CHalfEdge *pH = m_pMesh->edgeHalfedge(pE, 0);
+        coefficients.push_back(Eigen::Triplet<double>(pE->idx(), m_pMesh->halfedgeSource(pH)->idx(), -1));
+        coefficients.push_back(Eigen::Triplet<double>(pE->idx(), m_pMesh->halfedgeTarget(pH)->idx(), 1));
+    }
+    m_d0.resize(m_ne, m_nv);
+    m_d0.setFromTriplets(coefficients.begin(), coefficients.end());
+
+    // 3. d1 and the stars, from the halfedges of each face
+    coefficients.clear();
+    m_star0 = Eigen::VectorXd::Zero(m_nv);
+    m_star1 = Eigen::VectorXd::Zero(m_ne);
+    m_star2 = Eigen::VectorXd::Zero(m_nf);
+    m_face_edge.resize(3 * m_nf);
+    m_face_sign.resize(3 * m_nf);
+    for (typename M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        typename M::CFace *pF = *fiter;
+        const int f = pF->idx();
+
+        typename M::CHalfEdge *pH[3];
+        pH[0] = m_pMesh->faceHalfedge(pF);
+        pH[1] = m_pMesh->halfedgeNext(pH[0]);
+        pH[2] = m_pMesh->halfedgeNext(pH[1]);
+
+        CPoint p[3], v[3];
+        for (int i = 0; i < 3; i++)
+        {
+            typename M::CEdge *pE = m_pMesh->halfedgeEdge(pH[i]);
+            double sign = (m_pMesh->edgeHalfedge(pE, 0) == pH[i]) ? 1 : -1;
+            m_face_edge[3 * f + i] = pE->idx();
+            m_face_sign[3 * f + i] = sign;
+            coefficients.push_back(Eigen::Triplet<double>(f, pE->idx(), sign));
+            p[i] = m_pMesh->halfedgeTarget(pH[i])->point();
+        }
+
+        // the halfedge i points from p[i-1] to p[i], its opposite corner is p[i+1]
+        for (int i = 0; i < 3; i++)
+            v[i] = p[i] - p[(i + 2) % 3];
+        const double area2 = (v[0] ^ v[1]).norm();
+        for (int i = 0; i < 3; i++)
+        {
+            // cot of the corner at p[i+1], between -v[i+1] and v[i+2]
+            double cot = -(v[(i + 1) % 3] * v[(i + 2) % 3]) / area2;
+            m_star1[m_face_edge[3 * f + i]] += 0.5 * cot;
+            m_star0[m_pMesh->halfedgeTarget(pH[i])->idx()] += area2 / 6;
+        }
+        m_star2[f] = 2 / area2;
+    }
+    m_d1.resize(m_nf, m_ne);
+    m_d1.setFromTriplets(coefficients.begin(), coefficients.end());
+
+    m_div = m_d0.transpose() * m_star1.asDiagonal();
+}
+
+template <typename M>
+double CDiscreteExteriorCalculus<M>::wedge_product(const Eigen::VectorXd &omega0, const Eigen::VectorXd &omega1)
+{
+    double p = 0;
+    for (int f = 0; f < m_nf; f++)
+    {
+        double a[3], b[3];
+        for (int i = 0; i < 3; i++)
+        {
+            a[i] = m_face_sign[3 * f + i] * omega0[m_face_edge[3 * f + i]];
+            b[i] = m_face_sign[3 * f + i] * omega1[m_face_edge[3 * f + i]];
+        }
+        for (int i = 0; i < 3; i++)
+            p += (a[i] * b[(i + 2) % 3] - a[i] * b[(i + 1) % 3]) / 6;
+    }
+    return p;
+}
+
+template <typename M>
+void CDiscreteExteriorCalculus<M>::wedge_gram(const Eigen::MatrixXd &omega, Eigen::MatrixXd &W, Eigen::MatrixXd &S)
+{
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> CRowMatrix;
+
+    const int n = (int)omega.cols();
+
+    // the values of all forms on an edge are contiguous
+    const CRowMatrix rows = omega;
+
+    W = Eigen::MatrixXd::Zero(n, n);
+#pragma omp parallel
+    {
+        Eigen::MatrixXd partial = Eigen::MatrixXd::Zero(n, n);
+        Eigen::MatrixXd a(3, n), c(3, n);
+
+#pragma omp for schedule(static)
+        for (int f = 0; f < m_nf; f++)
+        {
+            for (int i = 0; i < 3; i++)
+                a.row(i) = m_face_sign[3 * f + i] * rows.row(m_face_edge[3 * f + i]);
+            for (int i = 0; i < 3; i++)
+                c.row(i) = a.row((i + 2) % 3) - a.row((i + 1) % 3);
+            partial.noalias() += a.transpose() * c;
+        }
+
+#pragma omp critical
+        W += partial;
+    }
+    W /= 6;
+
+    // star1 is diagonal, the wedge-star products are a single weighted product
+    S = omega.transpose() * (m_star1.asDiagonal() * omega);
+}
+
+template <typename M>
+void CDiscreteExteriorCalculus<M>::_match_edges(M *pForm, std::vector<typename M::CEdge *> &edges)
+{
+    edges.clear();
+    edges.reserve(m_ne);
+    if (pForm->numEdges() != m_ne)
+    {
+        std::cerr << "The form mesh does not match the mesh" << std::endl;
+        return;
+    }
+
+    // copies of the same mesh list their edges in the same order, fall back to
+    // a lookup by the vertex ids otherwise
+    for (typename M::MeshEdgeIterator_ eiter(pForm); !eiter.end(); ++eiter)
+    {
+        typename M::CEdge *pE = *eiter;
+        const int e = (int)edges.size();
+        if (pForm->edgeVertex1(pE)->id() != m_edge_ids[2 * e] || pForm->edgeVertex2(pE)->id() != m_edge_ids[2 * e + 1])
+        {
+            typename M::CVertex *v1 = pForm->idVertex(m_edge_ids[2 * e]);
+            typename M::CVertex *v2 = pForm->idVertex(m_edge_ids[2 * e + 1]);
+            pE = pForm->vertexEdge(v1, v2);
+        }
+        edges.push_back(pE);
+    }
+}
+
+template <typename M> void CDiscreteExteriorCalculus<M>::get_halfedge_form(M *pForm, Eigen::VectorXd &omega)
+{
+    std::vector<typename M::CEdge *> edges;
+    _match_edges(pForm, edges);
+    omega.resize(edges.size());
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        typename M::CHalfEdge *pH = pForm->edgeHalfedge(edges[e], 0);
+        // the matched edge may point the other way
+        double sign = (pForm->halfedgeSource(pH)->id() == m_edge_ids[2 * e]) ? 1 : -1;
+        omega[e] = sign * pH->form();
+    }
+}
+
+template <typename M> void CDiscreteExteriorCalculus<M>::set_halfedge_form(M *pForm, const Eigen::VectorXd &omega)
+{
+    std::vector<typename M::CEdge *> edges;
+    _match_edges(pForm, edges);
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        typename M::CHalfEdge *pH = pForm->edgeHalfedge(edges[e], 0);
+        double sign = (pForm->halfedgeSource(pH)->id() == m_edge_ids[2 * e]) ? 1 : -1;
+        pH->form() = sign * omega[e];
+        if (typename M::CHalfEdge *pS = pForm->edgeHalfedge(edges[e], 1))
+            pS->form() = -sign * omega[e];
+    }
+}
+
+template <typename M> void CDiscreteExteriorCalculus<M>::get_du(M *pForm, Eigen::VectorXd &omega)
+{
+    std::vector<typename M::CEdge *> edges;
+    _match_edges(pForm, edges);
+    omega.resize(edges.size());
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        typename M::CHalfEdge *pH = pForm->edgeHalfedge(edges[e], 0);
+        double sign = (pForm->halfedgeSource(pH)->id() == m_edge_ids[2 * e]) ? 1 : -1;
+        omega[e] = sign * edges[e]->du();
+    }
+}
+
+template <typename M> void CDiscreteExteriorCalculus<M>::set_du(M *pForm, const Eigen::VectorXd &omega)
+{
+    std::vector<typename M::CEdge *> edges;
+    _match_edges(pForm, edges);
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        typename M::CHalfEdge *pH = pForm->edgeHalfedge(edges[e], 0);
+        double sign = (pForm->halfedgeSource(pH)->id() == m_edge_ids[2 * e]) ? 1 : -1;
+        edges[e]->du() = sign * omega[e];
+    }
+}
+
+template <typename M>
+void CDiscreteExteriorCalculus<M>::set_duv(M *pForm, const Eigen::VectorXd &omega, const Eigen::VectorXd &conjugate)
+{
+    std::vector<typename M::CEdge *> edges;
+    _match_edges(pForm, edges);
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        typename M::CHalfEdge *pH = pForm->edgeHalfedge(edges[e], 0);
+        double sign = (pForm->halfedgeSource(pH)->id() == m_edge_ids[2 * e]) ? 1 : -1;
+        edges[e]->duv()[0] = sign * omega[e];
+        edges[e]->duv()[1] = sign * conjugate[e];
+    }
+}
+
+} // namespace MeshLib
+#endif // !_DISCRETE_EXTERIOR_CALCULUS_H_
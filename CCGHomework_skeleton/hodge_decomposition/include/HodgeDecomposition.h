@@ -1,11 +1,87 @@
 #ifndef _HODGE_DECOMPOSITION_H_
 #define _HODGE_DECOMPOSITION_H_
 
+#include <Eigen/Sparse>
+#include <vector>
+
+#include "DiscreteExteriorCalculus.h"
 #include "HodgeDecompositionMesh.h"
 
 namespace MeshLib
 {
 
+/*! \brief CFormResidual
+ *
+ *   Residual of a closedness or coclosedness test
+ */
+struct CFormResidual
+{
+    /*! largest absolute residual */
+    double max_error;
+    /*! root mean squared residual */
+    double rms_error;
+    /*! face or vertex idx of the largest residual, -1 if not evaluated */
+    int argmax;
+    /*! number of evaluated faces or vertices */
+    int samples;
+};
+
+/*! \brief CFormResiduals
+ *
+ *   Residuals of one harmonic form
+ */
+struct CFormResiduals
+{
+    /*! the form, in the order of computation */
+    int form;
+    /*! d omega on the faces */
+    CFormResidual closedness;
+    /*! d0^T star1 omega on the interior vertices */
+    CFormResidual coclosedness;
+};
+
+/*! \brief CIntegrationTree
+ *
+ *   Breadth first spanning tree of a domain mesh as flat arrays, with the
+ *   edges of the form meshes matched once
+ */
+struct CIntegrationTree
+{
+    /*! domain mesh */
+    CHodgeDecompositionMesh *pDomain;
+    /*! number of edges of the form meshes */
+    int form_edges;
+    /*! vertices in breadth first order, the root first */
+    std::vector<CHodgeDecompositionMesh::CVertex *> vertices;
+    /*! domain edge to the parent */
+    std::vector<CHodgeDecompositionMesh::CEdge *> edges;
+    /*! position of the parent in vertices */
+    std::vector<int> parent;
+    /*! form edge, in the edge order of the form meshes */
+    std::vector<int> form_edge;
+    /*! +1 if the form edge points from the parent to the vertex, -1 otherwise */
+    std::vector<double> sign;
+};
+
+/*! \brief CLaplacian
+ *
+ *   Laplacian of the decomposition, singular with the constants as kernel
+ *   on closed meshes
+ */
+struct CLaplacian
+{
+    /*! the matrix */
+    Eigen::SparseMatrix<double> A;
+    /*! Cholesky factor of A, or of A without row and column 0 if singular */
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> solver;
+    /*! inverse diagonal, the preconditioner of conjugate gradient */
+    Eigen::VectorXd inverse_diagonal;
+    /*! the constants are in the kernel */
+    bool singular;
+    /*! the Cholesky factor is computed */
+    bool factored;
+};
+
 /*! \brief CHodgeDecomposition class
  *
  *   Hodge Decomposition
@@ -13,11 +89,30 @@ namespace MeshLib
 class CHodgeDecomposition
 {
   public:
+    /*! solvers of the singular Laplacians */
+    enum
+    {
+        /*! Cholesky, the first vertex or face is pinned to 0 */
+        LAPLACIAN_PIN = 0,
+        /*! Cholesky with the pin, then the kernel is removed from the solution, which has mean 0 */
+        LAPLACIAN_MEAN_ZERO = 1,
+        /*! conjugate gradient, the right hand side and every residual are projected out of the kernel */
+        LAPLACIAN_PROJECTED_CG = 2
+    };
+
     /*!
      *  CHodgeDecomposition constructor
      */
     CHodgeDecomposition();
 
+    /*!
+     *  CHodgeDecomposition destructor
+     */
+    ~CHodgeDecomposition();
+
+    /*!
+     *  Set mesh, build its exterior derivatives and Hodge stars
+     */
     void set_mesh(CHodgeDecompositionMesh *pMesh);
 
     /*!
@@ -29,62 +124,183 @@ class CHodgeDecomposition
      */
     void exact_harmonic_form(int bnd_id);
 
+    /*!
+     *  Integrate the complex 1-form duv() of a mesh on the domain mesh, and
+     *  store the result in the domain uv(). The spanning tree of the domain
+     *  and the edge map to the form are built once and reused for all the
+     *  forms with the same connectivity, until set_mesh() or
+     *  invalidate_integration_tree().
+     *  \param pForm mesh storing the 1-form
+     *  \param pDomain the domain, whose vertex father() ids are vertices of pForm
+     */
     void integration(CHodgeDecompositionMesh *pForm, CHodgeDecompositionMesh *pDomain);
 
-  protected:
     /*!
-     * Compute angle using cosine law
-     * \param a first edge length
-     * \param b second edge length
-     * \param c third edge length
-     * \return angle between 1st and 2nd edges
+     *  Integrate several complex 1-forms on the same domain
+     *  \param forms copies of the same mesh storing the 1-forms in duv()
+     *  \param pDomain the domain mesh
+     *  \param uvs uvs[j][i] the integral of forms[j] at the domain vertex with idx() i
+     */
+    void integration(std::vector<CHodgeDecompositionMesh *> &forms, CHodgeDecompositionMesh *pDomain,
+                     std::vector<std::vector<CPoint2>> &uvs);
+
+    /*!
+     *  Drop the integration tree, call it when the domain mesh is modified,
+     *  re-read or freed
+     */
+    void invalidate_integration_tree();
+
+    /*!
+     *  Factor the face Laplacian d1 W^-1 d1^T (combinatorial weights W) and
+     *  the vertex Laplacian d0^T star1 d0 of the current mesh once. Both Laplacians are singular up to the
+     *  constants, the face Laplacian only for closed meshes, see laplacian_solver().
+     *  \param coexact false to factor the vertex Laplacian only, enough for closed forms
+     */
+    void factorize(bool coexact = true);
+
+    /*!
+     *  Remove the exact and coexact parts of the 1-forms stored in several
+     *  meshes, which share the connectivity and geometry of the factorized
+     *  mesh. All forms are projected at once by back-substitution with a
+     *  multi-column right hand side, then normalized.
+     *  \param forms meshes storing the 1-forms on the halfedges
+     */
+    void harmonic_projection(std::vector<CHodgeDecompositionMesh *> &forms);
+
+    /*!
+     *  Compute a random harmonic form on each of the meshes, factorizes the
+     *  current mesh first if needed
+     *  \param forms copies of the current mesh
      */
-    double _inverse_cosine_law(double a, double b, double c);
+    void random_harmonic_forms(std::vector<CHodgeDecompositionMesh *> &forms);
 
-    /*! exterior differentiation operator */
-    void _d(int dimension);
+    /*!
+     *  Compute a deterministic basis of the harmonic 1-forms. A tree-cotree
+     *  decomposition gives one closed, non-exact 1-form per generator edge
+     *  in linear time, the exact parts of all of them are removed with one
+     *  factorization of the vertex Laplacian.
+     *  \param forms copies of the current mesh, one per generator (2g for
+     *  closed meshes, 2g + b - 1 with b boundaries)
+     */
+    void cohomology_basis(std::vector<CHodgeDecompositionMesh *> &forms);
 
-    /*! delta operator */
-    void _delta(int dimension);
+    /*!
+     *  Mark the cut graph of the current mesh as the sharp edges: the edges
+     *  whose duals are not in a spanning tree of the faces, pruned to the
+     *  loops and the slits between the boundaries. Slicing the mesh along it
+     *  with CMeshSlicer gives a topological disk, the integration domain.
+     */
+    void cut_graph();
 
     /*!
-     *  Compute edge weight
+     *  Stride of the closedness and coclosedness tests, 0 switches them off,
+     *  1 evaluates every face and vertex, s > 1 every s-th one
      */
-    void _calculate_edge_weight(bool using_geometry);
-    /*! find the exact form */
-    void _compute_exact_form();
+    int &residual_sampling()
+    {
+        return m_residual_sampling;
+    };
+
+    /*! residuals of the computed forms */
+    std::vector<CFormResiduals> &residuals()
+    {
+        return m_residuals;
+    };
+
+    /*! write the residuals to a JSON file */
+    void write_residuals(const char *filename);
 
-    /*! find the coexact form */
-    void _compute_coexact_form();
+    /*! solver of the face and vertex Laplacians, LAPLACIAN_PIN by default */
+    int &laplacian_solver()
+    {
+        return m_laplacian_solver;
+    };
 
-    /*! compute the harmonic form */
+    /*! relative residual of the projected conjugate gradient */
+    double &cg_tolerance()
+    {
+        return m_cg_tolerance;
+    };
+
+  protected:
+    /*! normalize the 1-form on the halfedges, and store it in du() */
     void _normalize();
 
     /*! random 1-form */
     void _random_form();
 
     /*! verify if the 1-form is closed */
-    void _test_closedness();
+    CFormResidual _test_closedness(const Eigen::VectorXd &omega);
 
-    /*! verify if the 1-form is closed */
-    void _test_coclosedness();
+    /*! verify if the 1-form is coclosed */
+    CFormResidual _test_coclosedness(const Eigen::VectorXd &omega);
+
+    /*! test both, record and print the residuals */
+    void _test_form(const Eigen::VectorXd &omega);
 
-    /*! remove df from \omega */
-    void _remove_exact_form();
-    /*! remove \delta \eta from \omega */
-    void _remove_coexact_form();
+    /*! residual A x on every sampled row of A, skipping the marked rows, in parallel */
+    CFormResidual _residual(const CDiscreteExteriorCalculus<CHodgeDecompositionMesh>::CSRMatrix &A,
+                            const Eigen::VectorXd &x, const std::vector<bool> *skip);
 
     /*! exact harmonic form */
     void _exact_harmonic_form();
 
+    /*! build the integration tree of the domain, indexes the domain vertices and the form edges */
+    void _integration_tree(CHodgeDecompositionMesh *pForm, CHodgeDecompositionMesh *pDomain);
+
+    /*! gather duv() of a form in its edge order */
+    void _gather_duv(CHodgeDecompositionMesh *pForm, std::vector<CPoint2> &duv);
+
     /*! set boundary conditions for exact harmonic forms */
     void _set_boundary_condition(int boundary_id);
 
+    /*! remove the exact parts of the columns of omega, normalize, and store them in the forms */
+    void _remove_exact_forms(Eigen::MatrixXd &omega, std::vector<CHodgeDecompositionMesh *> &forms);
+
+    /*! closed, non-exact 1-forms dual to the generators of a tree-cotree decomposition, one per column
+     *  \return number of generators
+     */
+    int _tree_cotree(Eigen::MatrixXd &omega);
+
+    /*! prepare a Laplacian for the current solver, factor it unless conjugate gradient is used */
+    void _factor(CLaplacian &L);
+
+    /*! solve L x = b with the current solver, one column per right hand side, and report the mean and residual */
+    Eigen::MatrixXd _solve(CLaplacian &L, const Eigen::MatrixXd &b);
+
+    /*! conjugate gradient on the complement of the constants */
+    int _projected_cg(CLaplacian &L, const Eigen::VectorXd &b, Eigen::VectorXd &x);
+
   protected:
     /*!
      * The input surface mesh
      */
     CHodgeDecompositionMesh *m_pMesh;
+
+    /*! exterior derivatives and Hodge stars of the input mesh */
+    CDiscreteExteriorCalculus<CHodgeDecompositionMesh> *m_pDEC;
+
+    /*! mesh whose Laplacians are factored */
+    CHodgeDecompositionMesh *m_pFactored;
+    /*! combinatorial edge weights of the face Laplacian */
+    Eigen::VectorXd m_face_weight;
+    /*! face and vertex Laplacians */
+    CLaplacian m_face_laplacian;
+    CLaplacian m_vertex_laplacian;
+    /*! the face Laplacian is factored too */
+    bool m_face_factored;
+    /*! solver of the Laplacians */
+    int m_laplacian_solver;
+    /*! tolerance of conjugate gradient */
+    double m_cg_tolerance;
+
+    /*! stride of the residual tests, 0 for none */
+    int m_residual_sampling;
+    /*! residuals of the computed forms */
+    std::vector<CFormResiduals> m_residuals;
+
+    /*! spanning tree of the last integration domain */
+    CIntegrationTree m_tree;
 };
 } // namespace MeshLib
 #endif // !_HODGE_DECOMPOSITION_H_
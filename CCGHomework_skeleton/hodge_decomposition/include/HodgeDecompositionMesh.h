@@ -105,7 +105,13 @@ class CHodgeDecompositionEdge : public CEdge
 {
   public:
     /*! Constructor */
-    CHodgeDecompositionEdge() : m_length(0), m_weight(0), m_form(0){};
+    CHodgeDecompositionEdge() : m_length(0), m_weight(0), m_form(0), m_index(0), m_sharp(false){};
+
+    /*! Edge index */
+    int &idx()
+    {
+        return m_index;
+    };
 
     /*!	Edge weight */
     double &weight()
@@ -134,6 +140,12 @@ class CHodgeDecompositionEdge : public CEdge
         return m_duv;
     };
 
+    /*! Sharp edge, on the cut graph */
+    bool &sharp()
+    {
+        return m_sharp;
+    };
+
   protected:
     /*!	Edge weight */
     double m_weight;
@@ -146,6 +158,10 @@ class CHodgeDecompositionEdge : public CEdge
 
     /*! duv */
     CPoint2 m_duv;
+    /*! Edge index */
+    int m_index;
+    /*! Sharp edge */
+    bool m_sharp;
 };
 
 // read harmonic 1-form trait "du" to the trait m_du
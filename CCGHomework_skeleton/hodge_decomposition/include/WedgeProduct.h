@@ -41,12 +41,14 @@
 #include <queue>
 #include <vector>
 
+#include "DiscreteExteriorCalculus.h"
+
 namespace MeshLib
 {
 
 /*! \brief CWedgeOperator class
  *
- *	Wedge Star Operator
+ *	Wedge Star Operator, evaluated with the discrete exterior calculus operators of the first mesh
  */
 template <typename M> class CWedgeOperator
 {
@@ -65,162 +67,34 @@ template <typename M> class CWedgeOperator
                             \int \omega_0 \wedge \omega_1
     \f]
      */
-    double wedge_product();
+    double wedge_product()
+    {
+        return m_dec.wedge_product(m_du[0], m_du[1]);
+    };
     /*! wedge product
      * \return
      *	\f[
                             \int \omega_0 \wedge {}^*\omega_1
     \f]
      */
-    double wedge_star_product();
-
-  private:
-    /*! Two input harmonic 1-forms $\f\omega_0,\omega_1\f$. */
-    M *m_pMesh[2];
-};
-
-template <typename M> double CWedgeOperator<M>::wedge_product()
-{
-
-    double p = 0;
-    for (typename M::MeshFaceIterator_ fiter(m_pMesh[0]); !fiter.end(); ++fiter)
+    double wedge_star_product()
     {
-        typename M::CFace *f0 = *fiter;
-        typename M::CFace *f1 = m_pMesh[1]->idFace(f0->id());
-
-        std::vector<typename M::CHalfEdge *> h0, h1;
-        for (typename M::FaceHalfedgeIterator_ fhiter(f0); !fhiter.end(); ++fhiter)
-        {
-            typename M::CHalfEdge *h = *fhiter;
-            h0.push_back(h);
-        }
-
-        for (typename M::FaceHalfedgeIterator_ fhiter(f1); !fhiter.end(); ++fhiter)
-        {
-            typename M::CHalfEdge *h = *fhiter;
-            h1.push_back(h);
-        }
-
-        typename M::CVertex *s0 = m_pMesh[0]->halfedgeSource(h0.front());
-        for (size_t i = 0; i < 3; i++)
-        {
-            typename M::CHalfEdge *h = h1.front();
-            typename M::CVertex *s = m_pMesh[1]->halfedgeSource(h);
-            if (s->id() != s0->id())
-            {
-                h1.erase(h1.begin());
-                h1.push_back(h);
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        std::vector<double> du0, du1;
-        for (size_t i = 0; i < 3; i++)
-        {
-            typename M::CHalfEdge *h = h0[i];
-            typename M::CEdge *e = m_pMesh[0]->halfedgeEdge(h);
-            double du = (h == m_pMesh[0]->edgeHalfedge(e, 0)) ? e->du() : -e->du();
-            du0.push_back(du);
-        }
-
-        for (size_t i = 0; i < 3; i++)
-        {
-            typename M::CHalfEdge *h = h1[i];
-            typename M::CEdge *e = m_pMesh[1]->halfedgeEdge(h);
-            double du = (h == m_pMesh[1]->edgeHalfedge(e, 0)) ? e->du() : -e->du();
-            du1.push_back(du);
-        }
-
-        // cross product
-        double p_ = 0;
-        for (size_t i = 0; i < 3; i++)
-        {
-            p_ += du0[i] * du1[(i - 1) % 3] - du0[i] * du1[(i + 1) % 3];
-        }
-
-        // wedge product on the face
-        p += p_ / 6;
-    }
-    return p;
-};
-
-// Hodge Star operator
-template <typename M> double CWedgeOperator<M>::wedge_star_product()
-{
-
-    double p = 0;
-    for (typename M::MeshFaceIterator_ fiter(m_pMesh[0]); !fiter.end(); ++fiter)
-    {
-        typename M::CFace *f0 = *fiter;
-        typename M::CFace *f1 = m_pMesh[1]->idFace(f0->id());
-
-        std::vector<typename M::CHalfEdge *> h0, h1;
-        for (typename M::FaceHalfedgeIterator_ fhiter(f0); !fhiter.end(); ++fhiter)
-        {
-            typename M::CHalfEdge *h = *fhiter;
-            h0.push_back(h);
-        }
-
-        for (typename M::FaceHalfedgeIterator_ fhiter(f1); !fhiter.end(); ++fhiter)
-        {
-            typename M::CHalfEdge *h = *fhiter;
-            h1.push_back(h);
-        }
-
-        typename M::CVertex *s0 = m_pMesh[0]->halfedgeSource(h0.front());
-        for (size_t i = 0; i < 3; i++)
-        {
-            typename M::CHalfEdge *h = h1.front();
-            typename M::CVertex *s = m_pMesh[1]->halfedgeSource(h);
-            if (s->id() != s0->id())
-            {
-                h1.erase(h1.begin());
-                h1.push_back(h);
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        std::vector<double> du0, du1, theta;
-        for (size_t i = 0; i < 3; i++)
-        {
-            typename M::CHalfEdge *h = h0[i];
-            typename M::CEdge *e = m_pMesh[0]->halfedgeEdge(h);
-            double du = (h == m_pMesh[0]->edgeHalfedge(e, 0)) ? e->du() : -e->du();
-            du0.push_back(du);
-            theta.push_back(h0[(i + 1) % 3]->angle());
-        }
-
-        for (size_t i = 0; i < 3; i++)
-        {
-            typename M::CHalfEdge *h = h1[i];
-            typename M::CEdge *e = m_pMesh[1]->halfedgeEdge(h);
-            double du = (h == m_pMesh[1]->edgeHalfedge(e, 0)) ? e->du() : -e->du();
-            du1.push_back(du);
-        }
-
-        double p_ = 0;
-        for (size_t i = 0; i < 3; i++)
-        {
-            p_ += du0[i] * du1[i] * std::tan(M_PI_2 - theta[i]);
-        }
+        return m_dec.wedge_star_product(m_du[0], m_du[1]);
+    };
 
-        p += p_ / 2;
-    }
-    return p;
+  private:
+    /*! DEC operators on the first mesh */
+    CDiscreteExteriorCalculus<M> m_dec;
+    /*! Two input harmonic 1-forms $\f\omega_0,\omega_1\f$, as edge vectors */
+    Eigen::VectorXd m_du[2];
 };
 
 // CWedgeOperator constructor
 //\param mesh0, mesh1 two input harmonic 1-forms
-template <typename M> CWedgeOperator<M>::CWedgeOperator(M *mesh0, M *mesh1)
+template <typename M> CWedgeOperator<M>::CWedgeOperator(M *mesh0, M *mesh1) : m_dec(mesh0)
 {
-    m_pMesh[0] = mesh0;
-    m_pMesh[1] = mesh1;
+    m_dec.get_du(mesh0, m_du[0]);
+    m_dec.get_du(mesh1, m_du[1]);
 };
 
 // CWedgeOperator destructor
@@ -280,36 +154,34 @@ template <typename M> CBaseHolomorphicForm<M>::~CBaseHolomorphicForm(){};
 // Compute the conjugate harmonic 1-forms for the base harmonic 1-forms
 template <typename M> void CBaseHolomorphicForm<M>::conjugate()
 {
-
-    //_angle_structure();
-
     int n = m_meshes.size();
+    if (n == 0)
+        return;
 
-    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(n, n);
-
+    // 1. gather the forms, one column per form
+    CDiscreteExteriorCalculus<M> dec(m_meshes[0]);
+    Eigen::MatrixXd omega(dec.numEdges(), n);
     for (int i = 0; i < n; i++)
     {
-        for (int j = 0; j < n; j++)
-        {
-            CWedgeOperator<M> wo(m_meshes[i], m_meshes[j]);
-            A(i, j) = wo.wedge_product();
-            // std::cout << "Wedge Product " << i << "," << j << " " << A(i, j) << " ";
-        }
-        std::cout << std::endl;
+        Eigen::VectorXd w;
+        dec.get_du(m_meshes[i], w);
+        if (w.size() != dec.numEdges())
+            return;
+        omega.col(i) = w;
     }
 
+    // 2. all the wedge and wedge-star products in one pass
+    Eigen::MatrixXd A, B;
+    dec.wedge_gram(omega, A, B);
+
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+
     for (int i = 0; i < n; i++)
     {
-        Eigen::VectorXd b(n);
-
-        for (int j = 0; j < n; j++)
-        {
-            CWedgeOperator<M> wo(m_meshes[i], m_meshes[j]);
-            b(j) = wo.wedge_star_product();
-        }
+        Eigen::VectorXd b = B.row(i).transpose();
 
         // Eigen::VectorXd x = solver.solve(b);
-        Eigen::VectorXd x = A.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
+        Eigen::VectorXd x = svd.solve(b);
 
         std::cout << "Hodge Star Coefficients: ";
         for (int j = 0; j < n; j++)
@@ -318,24 +190,9 @@ template <typename M> void CBaseHolomorphicForm<M>::conjugate()
         }
         std::cout << std::endl;
 
-        for (typename M::MeshEdgeIterator_ eiter(m_meshes[i]); !eiter.end(); ++eiter)
-        {
-            typename M::CEdge *e = *eiter;
-            e->duv()[0] = e->du();
-            e->duv()[1] = 0;
-
-            int id1 = m_meshes[i]->edgeVertex1(e)->id();
-            int id2 = m_meshes[i]->edgeVertex2(e)->id();
-
-            for (int k = 0; k < n; k++)
-            {
-                typename M::CVertex *w1 = m_meshes[k]->idVertex(id1);
-                typename M::CVertex *w2 = m_meshes[k]->idVertex(id2);
-
-                typename M::CEdge *edge = m_meshes[k]->vertexEdge(w1, w2);
-                e->duv()[1] += edge->du() * x(k);
-            }
-        }
+        // 3. the conjugate form is the combination of the bases
+        Eigen::VectorXd conjugate = omega * x;
+        dec.set_duv(m_meshes[i], omega.col(i), conjugate);
     }
 };
 
@@ -1,293 +1,249 @@
 #include <Eigen/Sparse>
 #include <cmath>
 #include <float.h>
+#include <fstream>
 #include <math.h>
+#include <queue>
 #include <time.h>
 
 #include "HodgeDecomposition.h"
+#include "Mesh/GraphPruner.h"
 #include "WedgeProduct.h"
 
-#ifndef M_PI
-#define M_PI 3.141592653589793238462643383279
-#endif
-
 MeshLib::CHodgeDecomposition::CHodgeDecomposition()
 {
     m_pMesh = NULL;
+    m_pDEC = NULL;
+    m_pFactored = NULL;
+    m_face_factored = false;
+    m_laplacian_solver = LAPLACIAN_PIN;
+    m_cg_tolerance = 1e-10;
+    m_face_laplacian.factored = false;
+    m_vertex_laplacian.factored = false;
+    m_residual_sampling = 1;
+    invalidate_integration_tree();
 }
 
-void MeshLib::CHodgeDecomposition::set_mesh(CHodgeDecompositionMesh *pMesh)
+MeshLib::CHodgeDecomposition::~CHodgeDecomposition()
 {
-    using M = CHodgeDecompositionMesh;
+    delete m_pDEC;
+}
 
+void MeshLib::CHodgeDecomposition::set_mesh(CHodgeDecompositionMesh *pMesh)
+{
     m_pMesh = pMesh;
 
-    // 1. index all the vertices
-    int vid = 0;
-    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
-    {
-        M::CVertex *pV = *viter;
-        pV->idx() = vid++;
-    }
+    // index all the cells, build d0, d1 and the Hodge stars
+    delete m_pDEC;
+    m_pDEC = new CDiscreteExteriorCalculus<CHodgeDecompositionMesh>(m_pMesh);
 
-    // 2. index all the faces
-    int fid = 0;
-    for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
-    {
-        M::CFace *pf = *fiter;
-        pf->idx() = fid++;
-    }
+    // the mesh may be a new one at the same address, or re-read in place, the
+    // factorization and the integration tree are rebuilt
+    m_pFactored = NULL;
+    invalidate_integration_tree();
+}
+
+void MeshLib::CHodgeDecomposition::invalidate_integration_tree()
+{
+    m_tree.pDomain = NULL;
+    m_tree.form_edges = 0;
+    m_tree.vertices.clear();
+    m_tree.edges.clear();
+    m_tree.parent.clear();
+    m_tree.form_edge.clear();
+    m_tree.sign.clear();
 }
 
-void MeshLib::CHodgeDecomposition::_calculate_edge_weight(bool using_geometry)
+void MeshLib::CHodgeDecomposition::_normalize()
+{
+    Eigen::VectorXd omega;
+    m_pDEC->get_halfedge_form(m_pMesh, omega);
+
+    double p = std::sqrt(m_pDEC->wedge_star_product(omega, omega));
+    omega /= p;
+
+    m_pDEC->set_halfedge_form(m_pMesh, omega);
+    m_pDEC->set_du(m_pMesh, omega);
+}
+
+void MeshLib::CHodgeDecomposition::_random_form()
 {
     using M = CHodgeDecompositionMesh;
 
-    if (!using_geometry)
+    // std::srand((unsigned)time(NULL));
+    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); eiter++)
     {
-        for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
+        double r = 2.0 * ((double)std::rand() / RAND_MAX - 0.5);
+        M::CEdge *pe = *eiter;
+        M::CHalfEdge *ph = m_pMesh->edgeHalfedge(pe, 0);
+        ph->form() = r;
+        M::CHalfEdge *ps = m_pMesh->edgeHalfedge(pe, 1);
+        if (ps != NULL)
         {
-            M::CEdge *pE = *eiter;
-            pE->weight() = (!pE->boundary()) ? 1.0 : 0.5;
+            ps->form() = -r;
         }
-        return;
     }
-    // using geometry to compute the cotangent edge weight
+}
 
-    // 1. compute edge length
-    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
-    {
-        M::CEdge *pE = *eiter;
-        M::CVertex *v1 = m_pMesh->edgeVertex1(pE);
-        M::CVertex *v2 = m_pMesh->edgeVertex2(pE);
-        pE->length() = (v1->point() - v2->point()).norm();
-    }
+MeshLib::CFormResidual MeshLib::CHodgeDecomposition::_residual(
+    const CDiscreteExteriorCalculus<CHodgeDecompositionMesh>::CSRMatrix &A, const Eigen::VectorXd &x,
+    const std::vector<bool> *skip)
+{
+    typedef CDiscreteExteriorCalculus<CHodgeDecompositionMesh>::CSRMatrix CSRMatrix;
 
-    // 2. compute corner angle
-    for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+    const int stride = m_residual_sampling;
+    const int rows = (int)A.rows();
+
+    CFormResidual r;
+    r.max_error = 0;
+    r.rms_error = 0;
+    r.argmax = -1;
+    r.samples = 0;
+
+    double squared_error = 0;
+    int samples = 0;
+#pragma omp parallel
     {
-        M::CFace *pF = *fiter;
-        M::CHalfEdge *pH[3];
-        pH[0] = m_pMesh->faceHalfedge(pF);
-        for (int i = 0; i < 3; i++)
-        {
-            pH[(i + 1) % 3] = m_pMesh->halfedgeNext(pH[i]);
-        }
+        double max_error = -1;
+        int argmax = -1;
 
-        double len[3];
-        for (int i = 0; i < 3; i++)
+#pragma omp for schedule(static) reduction(+ : squared_error, samples)
+        for (int i = 0; i < rows; i += stride)
         {
-            len[i] = m_pMesh->halfedgeEdge(pH[i])->length();
+            if (skip && (*skip)[i])
+                continue;
+
+            double w = 0;
+            for (CSRMatrix::InnerIterator it(A, i); it; ++it)
+                w += it.value() * x[it.col()];
+
+            squared_error += w * w;
+            samples++;
+            if (fabs(w) > max_error)
+            {
+                max_error = fabs(w);
+                argmax = i;
+            }
         }
 
-        for (int i = 0; i < 3; i++)
+#pragma omp critical
+        if (argmax >= 0 &&
+            (r.argmax < 0 || max_error > r.max_error || (max_error == r.max_error && argmax < r.argmax)))
         {
-            double a = len[(i + 1) % 3], b = len[(i + 2) % 3], c = len[i];
-            pH[(i + 1) % 3]->angle() = _inverse_cosine_law(a, b, c);
+            r.max_error = max_error;
+            r.argmax = argmax;
         }
     }
 
-    // 3. compute edge weight
-    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
-    {
-        M::CEdge *pE = *eiter;
+    r.samples = samples;
+    if (samples > 0)
+        r.rms_error = std::sqrt(squared_error / samples); // root mean error
+    return r;
+}
 
-        if (!pE->boundary())
-        {
-            double theta[2];
-            theta[0] = m_pMesh->halfedgeNext(m_pMesh->edgeHalfedge(pE, 0))->angle();
-            theta[1] = m_pMesh->halfedgeNext(m_pMesh->edgeHalfedge(pE, 1))->angle();
-            pE->weight() = std::tan(M_PI_2 - theta[0]) + std::tan(M_PI_2 - theta[1]);
-        }
-        else
-        {
-            double theta = m_pMesh->halfedgeNext(m_pMesh->edgeHalfedge(pE, 0))->angle();
-            pE->weight() = std::tan(M_PI_2 - theta);
-        }
-    }
+MeshLib::CFormResidual MeshLib::CHodgeDecomposition::_test_closedness(const Eigen::VectorXd &omega)
+{
+    // d omega on the faces
+    return _residual(m_pDEC->d1(), omega, NULL);
 }
 
-double MeshLib::CHodgeDecomposition::_inverse_cosine_law(double a, double b, double c)
+MeshLib::CFormResidual MeshLib::CHodgeDecomposition::_test_coclosedness(const Eigen::VectorXd &omega)
 {
-    double cs = (a * a + b * b - c * c) / (2.0 * a * b);
-    assert(cs <= 1.0 && cs >= -1.0);
-    return std::acos(cs);
+    // d0^T star1 omega on the interior vertices
+    return _residual(m_pDEC->divergence(), omega, &m_pDEC->boundary_vertices());
 }
 
-void MeshLib::CHodgeDecomposition::_d(int dimension)
+void MeshLib::CHodgeDecomposition::_test_form(const Eigen::VectorXd &omega)
 {
-    if (dimension >= 2)
+    if (m_residual_sampling <= 0)
         return;
 
-    using M = CHodgeDecompositionMesh;
+    CFormResiduals r;
+    r.form = (int)m_residuals.size();
+    r.closedness = _test_closedness(omega);
+    r.coclosedness = _test_coclosedness(omega);
+    m_residuals.push_back(r);
 
-    if (dimension == 0)
-    {
-        for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); fiter++)
-        {
-            M::CFace *pf = *fiter;
-            for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); fhiter++)
-            {
-                M::CHalfEdge *ph = *fhiter;
-                ph->form() -= m_pMesh->halfedgeSource(ph)->form();
-                ph->form() += m_pMesh->halfedgeTarget(ph)->form();
-            }
-        }
-        return;
-    }
-
-    if (dimension == 1)
-    {
-        for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); fiter++)
-        {
-            M::CFace *pf = *fiter;
-            pf->form() = 0;
-            for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); fhiter++)
-            {
-                M::CHalfEdge *ph = *fhiter;
-                pf->form() += ph->form();
-            }
-        }
-        return;
-    }
+    std::cout << "Closedness: Max Error " << r.closedness.max_error << "  Root Mean Squared Error "
+              << r.closedness.rms_error << std::endl;
+    std::cout << "CoClosedness: Max Error " << r.coclosedness.max_error << "  Root Mean Squared Error "
+              << r.coclosedness.rms_error << std::endl;
 }
 
-void MeshLib::CHodgeDecomposition::_delta(int dimension)
+void MeshLib::CHodgeDecomposition::write_residuals(const char *filename)
 {
-    using M = CHodgeDecompositionMesh;
-
-    if (dimension == 2)
+    std::ofstream os(filename);
+    if (!os.good())
     {
-        for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); fiter++)
-        {
-            M::CFace *pf = *fiter;
-            for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); fhiter++)
-            {
-                M::CHalfEdge *ph = *fhiter;
-                M::CEdge *pe = m_pMesh->halfedgeEdge(ph);
-                double Sigma = m_pMesh->halfedgeFace(ph)->form();
-                ph->form() = (pf->form() - Sigma) / pe->weight();
-            }
-        }
+        std::cerr << "Error: can not open " << filename << std::endl;
         return;
     }
 
-    if (dimension == 1)
+    os.precision(17);
+    os << "{\n  \"sampling\": " << m_residual_sampling << ",\n  \"forms\": [";
+    for (size_t i = 0; i < m_residuals.size(); i++)
     {
-        for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); viter++)
+        CFormResiduals &r = m_residuals[i];
+        const char *names[2] = {"closedness", "coclosedness"};
+        CFormResidual *rs[2] = {&r.closedness, &r.coclosedness};
+
+        os << (i ? "," : "") << "\n    {\"form\": " << r.form;
+        for (int k = 0; k < 2; k++)
         {
-            M::CVertex *pv = *viter;
-            pv->form() = 0;
-            for (M::VertexOutHalfedgeIterator_ vhiter(m_pMesh, pv); !vhiter.end(); vhiter++)
-            {
-                M::CHalfEdge *ph = *vhiter;
-                M::CEdge *pe = m_pMesh->halfedgeEdge(ph);
-                pv->form() += pe->weight() * ph->form();
-            }
-            if (pv->boundary())
-            {
-                M::CHalfEdge *ph = m_pMesh->vertexMostCcwInHalfEdge(pv);
-                M::CEdge *pe = m_pMesh->halfedgeEdge(ph);
-                pv->form() -= pe->weight() * ph->form();
-            }
+            os << ", \"" << names[k] << "\": {\"max\": " << rs[k]->max_error << ", \"rms\": " << rs[k]->rms_error
+               << ", \"argmax\": " << rs[k]->argmax << ", \"samples\": " << rs[k]->samples << "}";
         }
-        return;
+        os << "}";
     }
+    os << "\n  ]\n}\n";
 }
 
-void MeshLib::CHodgeDecomposition::_remove_exact_form()
+void MeshLib::CHodgeDecomposition::random_harmonic_form()
 {
-    std::cout << "remove exact form" << std::endl;
+    _random_form();
 
-    using M = CHodgeDecompositionMesh;
-    M *pM = m_pMesh;
-    // remove exact-form
-    for (M::MeshFaceIterator_ fiter(pM); !fiter.end(); fiter++)
-    {
-        M::CFace *pf = *fiter;
-        for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); fhiter++)
-        {
-            M::CHalfEdge *ph = *fhiter;
-            double dEta = m_pMesh->halfedgeTarget(ph)->form() - m_pMesh->halfedgeSource(ph)->form();
-            ph->form() -= dEta;
-        }
-    }
+    std::vector<CHodgeDecompositionMesh *> forms(1, m_pMesh);
+    harmonic_projection(forms);
 }
 
-void MeshLib::CHodgeDecomposition::_normalize()
+void MeshLib::CHodgeDecomposition::_exact_harmonic_form()
 {
     using M = CHodgeDecompositionMesh;
 
-    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); eiter++)
-    {
-        M::CEdge *pe = *eiter;
-        M::CHalfEdge *ph = m_pMesh->edgeHalfedge(pe, 0);
-        pe->du() = ph->form();
-    }
-    CWedgeOperator<M> W(m_pMesh, m_pMesh);
-    double p = W.wedge_star_product();
-    p = sqrt(p);
-
-    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); eiter++)
-    {
-        M::CEdge *pe = *eiter;
-        M::CHalfEdge *ph = m_pMesh->edgeHalfedge(pe, 0);
-        pe->du() /= p;
-    }
+    // 1. the Laplacian d0^T star1 d0, split into interior and boundary blocks
+    Eigen::SparseMatrix<double> L = m_pDEC->d0().transpose() * m_pDEC->star1().asDiagonal() * m_pDEC->d0();
 
-    for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); fiter++)
+    std::vector<bool> &boundary = m_pDEC->boundary_vertices();
+    std::vector<int> local(boundary.size());
+    int interior_vertices = 0; // interior vertex id
+    int boundary_vertices = 0; // boundary vertex id
+    for (size_t i = 0; i < boundary.size(); i++)
     {
-        M::CFace *pf = *fiter;
-        double w = 0;
-        for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); fhiter++)
-        {
-            M::CHalfEdge *ph = *fhiter;
-            ph->form() /= p;
-        }
+        local[i] = boundary[i] ? boundary_vertices++ : interior_vertices++;
     }
-}
-
-void MeshLib::CHodgeDecomposition::_compute_exact_form()
-{
-    std::cout << "compute exact form" << std::endl;
-
-    using M = CHodgeDecompositionMesh;
 
-    // 1. Initialize
-
-    // 2. Set the matrix A
     std::vector<Eigen::Triplet<double>> A_coefficients;
-
-    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    std::vector<Eigen::Triplet<double>> B_coefficients;
+    for (int k = 0; k < L.outerSize(); ++k)
     {
-        M::CVertex *pV = *viter;
-
-        int vid = pV->idx();
-
-        double sw = 0;
-        for (M::VertexVertexIterator_ witer(pV); !witer.end(); ++witer)
+        for (Eigen::SparseMatrix<double>::InnerIterator it(L, k); it; ++it)
         {
-            M::CVertex *pW = *witer;
-            int wid = pW->idx();
-
-            M::CEdge *e = m_pMesh->vertexEdge(pV, pW);
-            double w = e->weight();
-            A_coefficients.push_back(Eigen::Triplet<double>(vid, wid, w));
-
-            sw += w;
+            if (boundary[it.row()])
+                continue;
+            if (boundary[it.col()])
+                B_coefficients.push_back(Eigen::Triplet<double>(local[it.row()], local[it.col()], -it.value()));
+            else
+                A_coefficients.push_back(Eigen::Triplet<double>(local[it.row()], local[it.col()], it.value()));
         }
-        A_coefficients.push_back(Eigen::Triplet<double>(vid, vid, -sw));
     }
 
-    Eigen::SparseMatrix<double> A(m_pMesh->numVertices(), m_pMesh->numVertices());
-    A.setZero();
+    Eigen::SparseMatrix<double> A(interior_vertices, interior_vertices);
+    Eigen::SparseMatrix<double> B(interior_vertices, boundary_vertices);
     A.setFromTriplets(A_coefficients.begin(), A_coefficients.end());
+    B.setFromTriplets(B_coefficients.begin(), B_coefficients.end());
 
-    // 3. compute delta tau
-    _delta(1);
-
-    // 4. Solve the equations
-    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>> solver;
+    // 2. Solve the equations
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> solver;
     std::cerr << "Eigen Decomposition" << std::endl;
     solver.compute(A);
     std::cerr << "Eigen Decomposition Finished" << std::endl;
@@ -297,444 +253,692 @@ void MeshLib::CHodgeDecomposition::_compute_exact_form()
         std::cerr << "Waring: Eigen decomposition failed" << std::endl;
     }
 
-    Eigen::VectorXd b(m_pMesh->numVertices());
-    // set boundary constraints vector b
+    Eigen::VectorXd b(boundary_vertices);
     for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
     {
         M::CVertex *pV = *viter;
-        int id = pV->idx();
-        b(id) = pV->form();
+        if (pV->boundary())
+            b(local[pV->idx()]) = pV->form();
     }
 
-    Eigen::VectorXd x = solver.solve(b); // Ax=b
-    if (solver.info() != Eigen::Success)
-    {
-        std::cerr << "Waring: Eigen decomposition failed" << std::endl;
-    }
+    Eigen::VectorXd x = solver.solve(B * b); // Ax=Bb
 
-    // set the images of the harmonic map to interior vertices
+    // 3. set the function on the interior vertices
     for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
     {
         M::CVertex *pV = *viter;
-        int id = pV->idx();
-        pV->form() = x(id);
+        if (!pV->boundary())
+            pV->form() = x(local[pV->idx()]);
     }
 }
 
-void MeshLib::CHodgeDecomposition::_random_form()
+void MeshLib::CHodgeDecomposition::_set_boundary_condition(int bid)
 {
     using M = CHodgeDecompositionMesh;
+    M::CBoundary_ bnd(m_pMesh);
+    std::vector<M::CLoop_ *> &Ls = bnd.loops();
 
-    // std::srand((unsigned)time(NULL));
-    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); eiter++)
+    for (size_t i = 0; i < Ls.size(); i++)
     {
-        double r = 2.0 * ((double)std::rand() / RAND_MAX - 0.5);
-        M::CEdge *pe = *eiter;
-        M::CHalfEdge *ph = m_pMesh->edgeHalfedge(pe, 0);
-        ph->form() = r;
-        M::CHalfEdge *ps = m_pMesh->edgeHalfedge(pe, 1);
-        if (ps != NULL)
+        std::list<M::CHalfEdge *> &pHs = Ls[i]->halfedges();
+        for (std::list<M::CHalfEdge *>::iterator hiter = pHs.begin(); hiter != pHs.end(); hiter++)
         {
-            ps->form() = -r;
+            M::CHalfEdge *ph = *hiter;
+            M::CVertex *pv = m_pMesh->halfedgeTarget(ph);
+            pv->form() = (i == bid) ? -1 : 0;
         }
     }
 }
 
-void MeshLib::CHodgeDecomposition::_compute_coexact_form()
+void MeshLib::CHodgeDecomposition::exact_harmonic_form(int bnd_id)
 {
-    std::cout << "compute coexact form" << std::endl;
+    using M = CHodgeDecompositionMesh;
+
+    _set_boundary_condition(bnd_id);
+    _exact_harmonic_form();
 
+    // omega = d f
+    Eigen::VectorXd f(m_pDEC->numVertices());
+    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex *pV = *viter;
+        f(pV->idx()) = pV->form();
+    }
+    Eigen::VectorXd omega = m_pDEC->d0() * f;
+    m_pDEC->set_halfedge_form(m_pMesh, omega);
+
+    _test_form(omega);
+    _normalize();
+}
+
+void MeshLib::CHodgeDecomposition::_integration_tree(CHodgeDecompositionMesh *pForm,
+                                                     CHodgeDecompositionMesh *pDomain)
+{
     using M = CHodgeDecompositionMesh;
 
-    // 1. Initialize
+    CIntegrationTree &tree = m_tree;
+    tree.pDomain = pDomain;
+    tree.form_edges = pForm->numEdges();
+    tree.vertices.clear();
+    tree.edges.clear();
+    tree.parent.clear();
+    tree.form_edge.clear();
+    tree.sign.clear();
 
-    // 2. Set the matrix A
-    std::vector<Eigen::Triplet<double>> A_coefficients;
+    // 1. index the edges of the form, in the edge order shared by its copies
+    int id = 0;
+    for (M::MeshEdgeIterator_ eiter(pForm); !eiter.end(); eiter++)
+    {
+        M::CEdge *e = *eiter;
+        e->idx() = id++;
+    }
+
+    M::CVertex *head = NULL;
 
-    for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+    id = 0;
+    for (M::MeshVertexIterator_ viter(pDomain); !viter.end(); viter++)
     {
-        M::CFace *pf = *fiter;
+        M::CVertex *v = *viter;
+        v->touched() = false;
+        v->idx() = id++;
+        head = v;
+    }
 
-        int fid = pf->idx();
+    // 2. breadth first search, each vertex stores the position of its parent
+    head->touched() = true;
+    tree.vertices.push_back(head);
+    tree.edges.push_back(NULL);
+    tree.parent.push_back(-1);
+    tree.form_edge.push_back(-1);
+    tree.sign.push_back(0);
 
-        double sw = 0;
-        for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); ++fhiter)
+    for (size_t k = 0; k < tree.vertices.size(); k++)
+    {
+        head = tree.vertices[k];
+
+        for (M::VertexEdgeIterator_ veiter(head); !veiter.end(); veiter++)
         {
-            M::CHalfEdge *ph = *fhiter;
-            M::CHalfEdge *ps = m_pMesh->halfedgeSym(ph);
+            M::CEdge *e = *veiter;
+            M::CVertex *v1 = pDomain->edgeVertex1(e);
+            M::CVertex *v2 = pDomain->edgeVertex2(e);
 
-            auto getWeight = [=](M::CHalfEdge *ph) { return m_pMesh->halfedgeEdge(ph)->weight(); };
+            M::CVertex *tail = (head != v1) ? v1 : v2;
+            if (tail->touched())
+                continue;
 
-            double w = -1 / getWeight(ph);
-            sw += w;
+            tail->touched() = true;
 
-            if (ps != NULL)
-            {
-                int fid_ = m_pMesh->halfedgeFace(ps)->idx();
-                A_coefficients.push_back(Eigen::Triplet<double>(fid, fid_, w));
-            }
-        }
-        A_coefficients.push_back(Eigen::Triplet<double>(fid, fid, -sw));
-    }
+            int id1 = head->father();
+            // if there is no "father" field for the vertex, then directly use the vertex id
+            if (id1 == 0)
+                id1 = head->id();
 
-    Eigen::SparseMatrix<double> A(m_pMesh->numFaces(), m_pMesh->numFaces());
-    A.setZero();
-    A.setFromTriplets(A_coefficients.begin(), A_coefficients.end());
+            int id2 = tail->father();
+            // if there is no "father" field for the vertex, then directly use the vertex id
+            if (id2 == 0)
+                id2 = tail->id();
 
-    // 3. compute delta tau
-    _d(1);
+            M::CVertex *w1 = pForm->idVertex(id1);
+            M::CVertex *w2 = pForm->idVertex(id2);
 
-    // 4. Solve the equations
-    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>> solver;
-    std::cerr << "Eigen Decomposition" << std::endl;
-    solver.compute(A);
-    std::cerr << "Eigen Decomposition Finished" << std::endl;
+            M::CEdge *we = pForm->vertexEdge(w1, w2);
 
-    if (solver.info() != Eigen::Success)
-    {
-        std::cerr << "Waring: Eigen decomposition failed" << std::endl;
+            tree.vertices.push_back(tail);
+            tree.edges.push_back(e);
+            tree.parent.push_back((int)k);
+            tree.form_edge.push_back(we->idx());
+            tree.sign.push_back((pForm->edgeVertex1(we) == w1) ? 1 : -1);
+        }
     }
+}
 
-    Eigen::VectorXd b(m_pMesh->numFaces());
-    // set boundary constraints vector b
-    for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
-    {
-        M::CFace *pF = *fiter;
-        int id = pF->idx();
-        b(id) = pF->form();
-    }
+void MeshLib::CHodgeDecomposition::_gather_duv(CHodgeDecompositionMesh *pForm, std::vector<CPoint2> &duv)
+{
+    using M = CHodgeDecompositionMesh;
 
-    Eigen::VectorXd x = solver.solve(b); // Ax=b
-    if (solver.info() != Eigen::Success)
+    duv.clear();
+    duv.reserve(pForm->numEdges());
+    for (M::MeshEdgeIterator_ eiter(pForm); !eiter.end(); eiter++)
     {
-        std::cerr << "Waring: Eigen decomposition failed" << std::endl;
+        M::CEdge *e = *eiter;
+        duv.push_back(e->duv());
     }
+}
 
-    // set the images of the harmonic map to interior vertices
-    for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); ++fiter)
+void MeshLib::CHodgeDecomposition::integration(CHodgeDecompositionMesh *pForm, CHodgeDecompositionMesh *pDomain)
+{
+    using M = CHodgeDecompositionMesh;
+
+    std::vector<M *> forms(1, pForm);
+    std::vector<std::vector<CPoint2>> uvs;
+    integration(forms, pDomain, uvs);
+    if (uvs.empty())
+        return;
+
+    CIntegrationTree &tree = m_tree;
+    std::vector<CPoint2> &uv = uvs[0];
+    for (size_t k = 0; k < tree.vertices.size(); k++)
     {
-        M::CFace *pF = *fiter;
-        int id = pF->idx();
-        pF->form() = x(id);
+        M::CVertex *v = tree.vertices[k];
+        v->uv() = uv[v->idx()];
+
+        // the tree edges keep the form oriented as the domain edges
+        M::CEdge *e = tree.edges[k];
+        if (e == NULL)
+            continue;
+        CPoint2 d = uv[v->idx()] - uv[tree.vertices[tree.parent[k]]->idx()];
+        e->duv() = (pDomain->edgeVertex2(e) == v) ? d : CPoint2(0, 0) - d;
     }
 }
 
-void MeshLib::CHodgeDecomposition::_test_closedness()
+void MeshLib::CHodgeDecomposition::integration(std::vector<CHodgeDecompositionMesh *> &forms,
+                                               CHodgeDecompositionMesh *pDomain,
+                                               std::vector<std::vector<CPoint2>> &uvs)
 {
-    double max_error = -1e+10;
-    double total_squared_error = 0;
+    uvs.clear();
+    if (forms.empty())
+        return;
 
-    using M = CHodgeDecompositionMesh;
-    for (M::MeshFaceIterator_ fiter(m_pMesh); !fiter.end(); fiter++)
+    // the tree holds pointers into the domain, it is reused until invalidate_integration_tree()
+    if (m_tree.vertices.empty() || m_tree.pDomain != pDomain)
     {
-        M::CFace *pf = *fiter;
-        double w = 0;
-        for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); fhiter++)
-        {
-            M::CHalfEdge *ph = *fhiter;
-            w += ph->form();
-        }
-        max_error = (max_error > fabs(w)) ? max_error : fabs(w);
-        total_squared_error += w * w;
+        _integration_tree(forms[0], pDomain);
+    }
+    if (m_tree.form_edges != forms[0]->numEdges())
+    {
+        std::cerr << "Error: the forms do not match the integration tree, call invalidate_integration_tree()"
+                  << std::endl;
+        return;
     }
-    total_squared_error /= m_pMesh->numFaces();
-    total_squared_error = sqrt(total_squared_error); // root mean error
 
-    std::cout << "Closedness: Max Error " << max_error << "  Root Mean Squared Error " << total_squared_error
-              << std::endl;
-}
+    CIntegrationTree &tree = m_tree;
+    const int n = (int)tree.vertices.size();
 
-void MeshLib::CHodgeDecomposition::_remove_coexact_form()
-{
-    std::cout << "remove coexact form" << std::endl;
+    // positions of the vertices in the tree, by idx
+    std::vector<int> index(n);
+    for (int k = 0; k < n; k++)
+        index[k] = tree.vertices[k]->idx();
 
-    using M = CHodgeDecompositionMesh;
-    M *pM = m_pMesh;
-    // remove coexact-form
-    for (M::MeshFaceIterator_ fiter(pM); !fiter.end(); fiter++)
+    uvs.resize(forms.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int j = 0; j < (int)forms.size(); j++)
     {
-        M::CFace *pf = *fiter;
-        for (M::FaceHalfedgeIterator_ fhiter(pf); !fhiter.end(); fhiter++)
-        {
-            M::CHalfEdge *ph = *fhiter;
-            M::CHalfEdge *ps = m_pMesh->halfedgeSym(ph);
-            double w = m_pMesh->halfedgeEdge(ph)->weight();
+        std::vector<CPoint2> duv;
+        _gather_duv(forms[j], duv);
 
-            double deltaSigma = 0;
-            if (ps != NULL)
-            {
-                deltaSigma = (pf->form() - m_pMesh->halfedgeFace(ps)->form()) / w;
-            }
-            else
-            {
-                deltaSigma = pf->form() / w;
-            }
-            ph->form() -= deltaSigma;
-        }
+        // 1. integrate in breadth first order, the parent is always done
+        std::vector<CPoint2> uv(n);
+        uv[0] = CPoint2(0, 0);
+        for (int k = 1; k < n; k++)
+            uv[k] = uv[tree.parent[k]] + duv[tree.form_edge[k]] * tree.sign[k];
+
+        // 2. scatter by the vertex idx
+        std::vector<CPoint2> &out = uvs[j];
+        out.resize(n);
+        for (int k = 0; k < n; k++)
+            out[index[k]] = uv[k];
     }
 }
 
-void MeshLib::CHodgeDecomposition::random_harmonic_form()
+void MeshLib::CHodgeDecomposition::_factor(CLaplacian &L)
 {
-    _random_form();
+    L.inverse_diagonal = L.A.diagonal().cwiseInverse();
+    L.factored = false;
+    if (m_laplacian_solver == LAPLACIAN_PROJECTED_CG)
+        return;
 
-    // don't need to use actual weight here as closedness is a topological invariant
-    _calculate_edge_weight(false);
-    _compute_coexact_form();
-    _remove_coexact_form();
-    _test_closedness();
-
-    // need to use actual weight here as coclosedness depends on the riemannian measure
-    // as coderivative operator uses hodge operator, which needs measure
-    _calculate_edge_weight(true);
-    _compute_exact_form();
-    _remove_exact_form();
-    _test_coclosedness();
-    _normalize();
+    // pin the entry 0 if the constants are in the kernel
+    const int n = (int)L.A.rows() - (L.singular ? 1 : 0);
+
+    Eigen::SparseMatrix<double> R = L.A.bottomRightCorner(n, n);
+    L.solver.compute(R);
+    if (L.solver.info() != Eigen::Success)
+    {
+        std::cerr << "Waring: Eigen decomposition failed" << std::endl;
+    }
+    L.factored = true;
 }
 
-void MeshLib::CHodgeDecomposition::_test_coclosedness()
+int MeshLib::CHodgeDecomposition::_projected_cg(CLaplacian &L, const Eigen::VectorXd &b, Eigen::VectorXd &x)
 {
-    using M = CHodgeDecompositionMesh;
-    double max_error = -1e+10;
-    double total_squared_error = 0;
-    int interior_vertices = 0;
+    const int n = (int)b.size();
+    const int max_iterations = 10 * n;
+
+    // the projection removes the constants, if they are in the kernel
+    auto project = [&](Eigen::VectorXd &v) {
+        if (L.singular)
+            v.array() -= v.mean();
+    };
+
+    Eigen::VectorXd r = b;
+    project(r);
+    const double threshold = m_cg_tolerance * r.norm();
+
+    x = Eigen::VectorXd::Zero(n);
+    Eigen::VectorXd z = L.inverse_diagonal.cwiseProduct(r);
+    project(z);
+    Eigen::VectorXd p = z;
+    Eigen::VectorXd q(n);
+    double rz = r.dot(z);
+
+    int k = 0;
+    while (k < max_iterations && r.norm() > threshold)
+    {
+        q.noalias() = L.A * p;
+        double alpha = rz / p.dot(q);
+        x += alpha * p;
+        r -= alpha * q;
+        project(r);
+
+        z = L.inverse_diagonal.cwiseProduct(r);
+        project(z);
+        double rz_new = r.dot(z);
+        p = z + (rz_new / rz) * p;
+        rz = rz_new;
+        k++;
+    }
+    project(x);
+    return k;
+}
 
-    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); viter++)
+Eigen::MatrixXd MeshLib::CHodgeDecomposition::_solve(CLaplacian &L, const Eigen::MatrixXd &b)
+{
+    const int rows = (int)b.rows();
+    Eigen::MatrixXd x = Eigen::MatrixXd::Zero(rows, b.cols());
+
+    int iterations = 0;
+    if (m_laplacian_solver == LAPLACIAN_PROJECTED_CG)
     {
-        M::CVertex *pv = *viter;
-        double w = 0;
-        for (M::VertexOutHalfedgeIterator_ vhiter(m_pMesh, pv); !vhiter.end(); vhiter++)
+        for (int j = 0; j < b.cols(); j++)
         {
-            M::CHalfEdge *ph = *vhiter;
-            M::CEdge *pe = m_pMesh->halfedgeEdge(ph);
-            w += pe->weight() * ph->form();
+            Eigen::VectorXd xj;
+            iterations = std::max(iterations, _projected_cg(L, b.col(j), xj));
+            x.col(j) = xj;
         }
-        if (pv->boundary())
+    }
+    else
+    {
+        // the solver was switched from conjugate gradient after factorize()
+        if (!L.factored)
+            _factor(L);
+
+        const int off = L.singular ? 1 : 0;
+        const int n = rows - off;
+        x.bottomRows(n) = L.solver.solve(b.bottomRows(n));
+
+        // the solution with mean 0 differs by a constant
+        if (L.singular && m_laplacian_solver == LAPLACIAN_MEAN_ZERO)
+            x.rowwise() -= x.colwise().mean();
+    }
+
+    // report the worst column, the residual is taken on the complement of the kernel
+    double mean = 0, residual = 0;
+    for (int j = 0; j < b.cols(); j++)
+    {
+        Eigen::VectorXd bj = b.col(j);
+        Eigen::VectorXd rj = L.A * x.col(j) - bj;
+        if (L.singular)
         {
-            M::CHalfEdge *ph = m_pMesh->vertexMostCcwInHalfEdge(pv);
-            M::CEdge *pe = m_pMesh->halfedgeEdge(ph);
-            w -= pe->weight() * ph->form();
+            bj.array() -= bj.mean();
+            rj.array() -= rj.mean();
         }
-        if (pv->boundary())
-            continue;
-        interior_vertices++;
-        max_error = (max_error > fabs(w)) ? max_error : fabs(w);
-        total_squared_error += w * w;
+        double nb = bj.norm();
+        mean = std::max(mean, fabs(x.col(j).mean()));
+        residual = std::max(residual, nb > 0 ? rj.norm() / nb : rj.norm());
     }
 
-    total_squared_error /= interior_vertices;
-    total_squared_error = sqrt(total_squared_error); // root mean error
+    std::cout << "Laplacian: Mean " << mean << "  Relative Residual " << residual;
+    if (m_laplacian_solver == LAPLACIAN_PROJECTED_CG)
+        std::cout << "  CG Iterations " << iterations;
+    std::cout << std::endl;
 
-    std::cout << "CoClosedness: Max Error " << max_error << "  Root Mean Squared Error " << total_squared_error
-              << std::endl;
+    return x;
 }
 
-void MeshLib::CHodgeDecomposition::_exact_harmonic_form()
+void MeshLib::CHodgeDecomposition::factorize(bool coexact)
 {
-
-    using M = CHodgeDecompositionMesh;
-
-    // 1. Initialize
-    int vid = 0; // interior vertex id
-    int bid = 0; // boundary vertex id
-    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    if (!m_pMesh)
     {
-        M::CVertex *pV = *viter;
-
-        if (pV->boundary())
-            pV->idx() = bid++;
-        else
-            pV->idx() = vid++;
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
     }
 
-    int interior_vertices = vid;
-    int boundary_vertices = bid;
+    CDiscreteExteriorCalculus<CHodgeDecompositionMesh> &dec = *m_pDEC;
 
-    // 2. Set the matrix A and B
-    std::vector<Eigen::Triplet<double>> A_coefficients;
-    std::vector<Eigen::Triplet<double>> B_coefficients;
+    std::cerr << "Eigen Decomposition" << std::endl;
 
-    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    // 1. closedness is a topological invariant, the face Laplacian uses the
+    //    combinatorial weights 1, and 1/2 on the boundary
+    if (coexact)
     {
-        M::CVertex *pV = *viter;
-        if (pV->boundary())
-            continue;
-        int vid = pV->idx();
-
-        double sw = 0;
-        for (M::VertexVertexIterator_ witer(pV); !witer.end(); ++witer)
+        std::vector<bool> &boundary = dec.boundary_edges();
+        m_face_weight.resize(dec.numEdges());
+        m_face_laplacian.singular = true;
+        for (int e = 0; e < dec.numEdges(); e++)
         {
-            M::CVertex *pW = *witer;
-            int wid = pW->idx();
-
-            M::CEdge *e = m_pMesh->vertexEdge(pV, pW);
-            double w = e->weight();
-
-            if (pW->boundary())
-            {
-                B_coefficients.push_back(Eigen::Triplet<double>(vid, wid, w));
-            }
-            else
-            {
-                A_coefficients.push_back(Eigen::Triplet<double>(vid, wid, -w));
-            }
-            sw += w;
+            m_face_weight[e] = boundary[e] ? 0.5 : 1.0;
+            if (boundary[e])
+                m_face_laplacian.singular = false;
         }
-        A_coefficients.push_back(Eigen::Triplet<double>(vid, vid, sw));
+        m_face_laplacian.A = dec.d1() * m_face_weight.cwiseInverse().asDiagonal() * dec.d1().transpose();
+        _factor(m_face_laplacian);
     }
 
-    Eigen::SparseMatrix<double> A(interior_vertices, interior_vertices);
-    A.setZero();
-    Eigen::SparseMatrix<double> B(interior_vertices, boundary_vertices);
-    B.setZero();
-    A.setFromTriplets(A_coefficients.begin(), A_coefficients.end());
-    B.setFromTriplets(B_coefficients.begin(), B_coefficients.end());
+    // 2. coclosedness depends on the metric, the vertex Laplacian uses star1
+    m_vertex_laplacian.A = dec.d0().transpose() * dec.star1().asDiagonal() * dec.d0();
+    m_vertex_laplacian.singular = true;
+    _factor(m_vertex_laplacian);
 
-    // 3. Solve the equations
-    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>> solver;
-    std::cerr << "Eigen Decomposition" << std::endl;
-    solver.compute(A);
     std::cerr << "Eigen Decomposition Finished" << std::endl;
 
-    if (solver.info() != Eigen::Success)
+    m_pFactored = m_pMesh;
+    m_face_factored = coexact;
+}
+
+void MeshLib::CHodgeDecomposition::harmonic_projection(std::vector<CHodgeDecompositionMesh *> &forms)
+{
+    if (!m_pMesh)
     {
-        std::cerr << "Waring: Eigen decomposition failed" << std::endl;
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
     }
+    if (m_pFactored != m_pMesh || !m_face_factored)
+        factorize();
+
+    CDiscreteExteriorCalculus<CHodgeDecompositionMesh> &dec = *m_pDEC;
+    const int k = (int)forms.size();
 
+    // 1. gather the forms, one column per form, all of them are checked before any is changed
+    Eigen::MatrixXd omega(dec.numEdges(), k);
+    for (int j = 0; j < k; j++)
     {
-        Eigen::VectorXd b(boundary_vertices);
-        // set boundary constraints vector b
-        for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+        Eigen::VectorXd w;
+        dec.get_halfedge_form(forms[j], w);
+        if (w.size() != dec.numEdges())
         {
-            M::CVertex *pV = *viter;
-            if (!pV->boundary())
-                continue;
-            int id = pV->idx();
-            b(id) = pV->form();
+            std::cerr << "Error: form " << j << " has " << w.size() << " edges, the mesh has " << dec.numEdges()
+                      << ", no form is projected" << std::endl;
+            return;
         }
+        omega.col(j) = w;
+    }
 
-        Eigen::VectorXd c(interior_vertices);
-        c = B * b;
-
-        Eigen::VectorXd x = solver.solve(c); // Ax=c
-        if (solver.info() != Eigen::Success)
-        {
-            std::cerr << "Waring: Eigen decomposition failed" << std::endl;
-        }
+    // 2. remove the coexact part, solve for the 2-form sigma with
+    //    d1 W^-1 d1^T sigma = d1 omega, then omega -= W^-1 d1^T sigma
+    std::cout << "remove coexact forms" << std::endl;
+    Eigen::MatrixXd sigma = _solve(m_face_laplacian, dec.d1() * omega);
+    omega -= m_face_weight.cwiseInverse().asDiagonal() * (dec.d1().transpose() * sigma);
 
-        // set the images of the harmonic map to interior vertices
-        for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
-        {
-            M::CVertex *pV = *viter;
-            if (pV->boundary())
-                continue;
-            int id = pV->idx();
-            pV->form() = x(id);
-        }
-    }
+    _remove_exact_forms(omega, forms);
 }
 
-void MeshLib::CHodgeDecomposition::_set_boundary_condition(int bid)
+void MeshLib::CHodgeDecomposition::_remove_exact_forms(Eigen::MatrixXd &omega,
+                                                       std::vector<CHodgeDecompositionMesh *> &forms)
 {
-    using M = CHodgeDecompositionMesh;
-    M::CBoundary_ bnd(m_pMesh);
-    std::vector<M::CLoop_ *> &Ls = bnd.loops();
+    CDiscreteExteriorCalculus<CHodgeDecompositionMesh> &dec = *m_pDEC;
 
-    for (size_t i = 0; i < Ls.size(); i++)
+    // 1. remove the exact part, solve for the function f with
+    //    d0^T star1 d0 f = d0^T star1 omega, then omega -= d0 f
+    std::cout << "remove exact forms" << std::endl;
+    Eigen::MatrixXd f = _solve(m_vertex_laplacian, dec.divergence() * omega);
+    omega -= dec.d0() * f;
+
+    // 2. normalize and scatter
+    for (int j = 0; j < (int)forms.size(); j++)
     {
-        std::list<M::CHalfEdge *> &pHs = Ls[i]->halfedges();
-        for (std::list<M::CHalfEdge *>::iterator hiter = pHs.begin(); hiter != pHs.end(); hiter++)
-        {
-            M::CHalfEdge *ph = *hiter;
-            M::CVertex *pv = m_pMesh->halfedgeTarget(ph);
-            pv->form() = (i == bid) ? -1 : 0;
-        }
+        Eigen::VectorXd w = omega.col(j);
+        _test_form(w);
+
+        w /= std::sqrt(dec.wedge_star_product(w, w));
+        dec.set_halfedge_form(forms[j], w);
+        dec.set_du(forms[j], w);
     }
 }
 
-void MeshLib::CHodgeDecomposition::exact_harmonic_form(int bnd_id)
+void MeshLib::CHodgeDecomposition::random_harmonic_forms(std::vector<CHodgeDecompositionMesh *> &forms)
 {
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
+    }
+
     using M = CHodgeDecompositionMesh;
 
-    _set_boundary_condition(bnd_id);
-    _calculate_edge_weight(true);
-    _exact_harmonic_form();
-    _d(0);
-    _test_closedness();
-    _test_coclosedness();
-    _normalize();
+    M *pMesh = m_pMesh;
+    for (size_t j = 0; j < forms.size(); j++)
+    {
+        m_pMesh = forms[j];
+        _random_form();
+    }
+    m_pMesh = pMesh;
+
+    harmonic_projection(forms);
 }
 
-void MeshLib::CHodgeDecomposition::integration(CHodgeDecompositionMesh *pForm, CHodgeDecompositionMesh *pDomain)
+int MeshLib::CHodgeDecomposition::_tree_cotree(Eigen::MatrixXd &omega)
 {
-    using M = CHodgeDecompositionMesh;
-
-    M::CVertex *head = NULL;
-
-    for (M::MeshVertexIterator_ viter(pDomain); !viter.end(); viter++)
-    {
-        M::CVertex *v = *viter;
-        v->touched() = false;
-        head = v;
+    typedef CDiscreteExteriorCalculus<CHodgeDecompositionMesh>::CSRMatrix CSRMatrix;
+    CDiscreteExteriorCalculus<CHodgeDecompositionMesh> &dec = *m_pDEC;
+
+    const int nv = dec.numVertices();
+    const int ne = dec.numEdges();
+    const int nf = dec.numFaces();
+
+    CSRMatrix &d0 = dec.d0();
+    CSRMatrix &d1 = dec.d1();
+    CSRMatrix vertex_edges = d0.transpose(); // #V x #E
+    CSRMatrix edge_faces = d1.transpose();   // #E x #F
+
+    // 0: free, 1: spanning tree, 2: cotree
+    std::vector<char> label(ne, 0);
+
+    // 1. breadth first spanning tree of the vertices
+    std::vector<bool> visited(nv, false);
+    std::queue<int> vq;
+    visited[0] = true;
+    vq.push(0);
+    while (!vq.empty())
+    {
+        int v = vq.front();
+        vq.pop();
+        for (CSRMatrix::InnerIterator eit(vertex_edges, v); eit; ++eit)
+        {
+            int e = (int)eit.col();
+            for (CSRMatrix::InnerIterator wit(d0, e); wit; ++wit)
+            {
+                int w = (int)wit.col();
+                if (visited[w])
+                    continue;
+                visited[w] = true;
+                label[e] = 1;
+                vq.push(w);
+            }
+        }
     }
 
-    std::queue<M::CVertex *> vqueue;
-    head->uv() = CPoint2(0, 0);
-    head->touched() = true;
+    // 2. breadth first spanning tree of the dual graph through the edges not in the tree,
+    //    all the boundary edges are dual to a virtual face nf, which is the root
+    std::vector<bool> &boundary = dec.boundary_edges();
+    bool open = false;
+    for (int e = 0; e < ne; e++)
+        open = open || boundary[e];
 
-    vqueue.push(head);
+    std::vector<int> parent_edge(nf + 1, -1);
+    std::vector<bool> reached(nf + 1, false);
+    std::vector<int> order;
+    order.reserve(nf + 1);
 
-    while (!vqueue.empty())
+    std::queue<int> fq;
+    const int root = open ? nf : 0;
+    reached[root] = true;
+    fq.push(root);
+    while (!fq.empty())
     {
-        head = vqueue.front();
-        vqueue.pop();
+        int f = fq.front();
+        fq.pop();
+        order.push_back(f);
 
-        for (M::VertexEdgeIterator_ veiter(head); !veiter.end(); veiter++)
+        std::vector<int> edges;
+        if (f == nf)
         {
-            M::CEdge *e = *veiter;
-            M::CVertex *v1 = pDomain->edgeVertex1(e);
-            M::CVertex *v2 = pDomain->edgeVertex2(e);
+            for (int e = 0; e < ne; e++)
+                if (boundary[e])
+                    edges.push_back(e);
+        }
+        else
+        {
+            for (CSRMatrix::InnerIterator eit(d1, f); eit; ++eit)
+                edges.push_back((int)eit.col());
+        }
 
-            M::CVertex *tail = (head != v1) ? v1 : v2;
-            if (tail->touched())
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            int e = edges[i];
+            if (label[e] != 0)
                 continue;
 
-            tail->touched() = true;
-            vqueue.push(tail);
+            int g = nf;
+            for (CSRMatrix::InnerIterator git(edge_faces, e); git; ++git)
+            {
+                if ((int)git.col() != f)
+                    g = (int)git.col();
+            }
+            if (g == f || reached[g])
+                continue;
 
-            int id1 = v1->father();
-            // if there is no "father" field for the vertex, then directly use the vertex id
-            if (id1 == 0)
-                id1 = v1->id();
+            reached[g] = true;
+            parent_edge[g] = e;
+            label[e] = 2;
+            fq.push(g);
+        }
+    }
 
-            int id2 = v2->father();
-            // if there is no "father" field for the vertex, then directly use the vertex id
-            if (id2 == 0)
-                id2 = v2->id();
+    // 3. each remaining edge generates a closed, non-exact 1-form, which is 1 on the edge,
+    //    0 on the other generators and the tree, and fixed on the cotree edges from the
+    //    leaves of the dual tree to the root, such that d omega = 0 on every face
+    std::vector<int> generators;
+    for (int e = 0; e < ne; e++)
+    {
+        if (label[e] == 0)
+            generators.push_back(e);
+    }
 
-            M::CVertex *w1 = pForm->idVertex(id1);
-            M::CVertex *w2 = pForm->idVertex(id2);
+    const int k = (int)generators.size();
+    omega = Eigen::MatrixXd::Zero(ne, k);
+    for (int j = 0; j < k; j++)
+        omega(generators[j], j) = 1;
 
-            M::CEdge *we = pForm->vertexEdge(w1, w2);
+    for (int i = (int)order.size() - 1; i > 0; i--)
+    {
+        int f = order[i];
+        int ep = parent_edge[f];
 
-            if (pForm->edgeVertex1(we) == w1)
-            {
-                e->duv() = we->duv();
-            }
+        double sp = 0;
+        Eigen::RowVectorXd s = Eigen::RowVectorXd::Zero(k);
+        for (CSRMatrix::InnerIterator eit(d1, f); eit; ++eit)
+        {
+            if ((int)eit.col() == ep)
+                sp = eit.value();
             else
-            {
-                e->duv() = CPoint2(0, 0) - we->duv();
-            }
+                s += eit.value() * omega.row(eit.col());
+        }
+        omega.row(ep) = -s / sp;
+    }
 
-            if (tail == v2)
-            {
-                tail->uv() = head->uv() + e->duv();
-            }
-            else
+    return k;
+}
+
+void MeshLib::CHodgeDecomposition::cut_graph()
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
+    }
+
+    typedef CDiscreteExteriorCalculus<CHodgeDecompositionMesh>::CSRMatrix CSRMatrix;
+    using M = CHodgeDecompositionMesh;
+    CDiscreteExteriorCalculus<CHodgeDecompositionMesh> &dec = *m_pDEC;
+
+    const int nv = dec.numVertices();
+    const int ne = dec.numEdges();
+    const int nf = dec.numFaces();
+    CSRMatrix &d0 = dec.d0();
+    CSRMatrix &d1 = dec.d1();
+    CSRMatrix vertex_edges = d0.transpose(); // #V x #E
+    CSRMatrix edge_faces = d1.transpose();   // #E x #F
+
+    // 1. breadth first spanning tree of the dual graph through the interior edges,
+    //    the mesh glued along the tree is a single disk
+    std::vector<bool> cut(ne, true);
+    std::vector<bool> reached(nf, false);
+    std::queue<int> fq;
+    reached[0] = true;
+    fq.push(0);
+    while (!fq.empty())
+    {
+        int f = fq.front();
+        fq.pop();
+        for (CSRMatrix::InnerIterator eit(d1, f); eit; ++eit)
+        {
+            int e = (int)eit.col();
+            for (CSRMatrix::InnerIterator git(edge_faces, e); git; ++git)
             {
-                tail->uv() = head->uv() - e->duv();
+                int g = (int)git.col();
+                if (reached[g])
+                    continue;
+                reached[g] = true;
+                cut[e] = false;
+                fq.push(g);
             }
         }
     }
+
+    // 2. prune the branches of the spanning tree off the loops, the edges whose duals
+    //    are not in the tree include the boundary loops, which keep the slits between
+    //    the boundaries from being pruned
+    std::vector<int> edge_vertex(2 * ne);
+    for (int e = 0; e < ne; e++)
+    {
+        int k = 0;
+        for (CSRMatrix::InnerIterator vit(d0, e); vit; ++vit)
+            edge_vertex[2 * e + k++] = (int)vit.col();
+    }
+    std::vector<int> valence;
+    prune_graph(nv, vertex_edges.outerIndexPtr(), vertex_edges.innerIndexPtr(), edge_vertex.data(), cut, valence);
+
+    // 3. the boundary is open already
+    std::vector<bool> &boundary = dec.boundary_edges();
+    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); eiter++)
+    {
+        M::CEdge *e = *eiter;
+        e->sharp() = cut[e->idx()] && !boundary[e->idx()];
+    }
+}
+
+void MeshLib::CHodgeDecomposition::cohomology_basis(std::vector<CHodgeDecompositionMesh *> &forms)
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
+    }
+
+    Eigen::MatrixXd omega;
+    int k = _tree_cotree(omega);
+    std::cout << "Tree-cotree: " << k << " generators" << std::endl;
+    if (k != (int)forms.size())
+    {
+        std::cerr << "Waring: " << forms.size() << " forms for " << k << " generators" << std::endl;
+        k = std::min(k, (int)forms.size());
+        omega.conservativeResize(Eigen::NoChange, k);
+    }
+    std::vector<CHodgeDecompositionMesh *> basis(forms.begin(), forms.begin() + k);
+
+    // the forms are closed, only the exact part is removed
+    if (m_pFactored != m_pMesh)
+        factorize(false);
+
+    _remove_exact_forms(omega, basis);
 }
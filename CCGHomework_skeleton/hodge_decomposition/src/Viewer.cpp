@@ -10,6 +10,7 @@
 
 #include "HodgeDecomposition.h"
 #include "HodgeDecompositionMesh.h"
+#include "Mesh/MeshSlicer.h"
 #include "WedgeProduct.h"
 #include "bmp/RgbImage.h"
 #include "viewer/Arcball.h" /*  Arc Ball  Interface         */
@@ -36,6 +37,8 @@ CArcball g_arcball;
 CHodgeDecompositionMesh *g_domain_mesh = NULL;
 std::vector<CHodgeDecompositionMesh *> g_meshes;
 CHodgeDecomposition g_mapper;
+/*! JSON file of the residuals */
+std::string g_residual_file;
 int g_show_index = 0;
 
 int g_texture_flag = 2;
@@ -292,6 +295,7 @@ void help()
     printf("s  -  Smooth Shading\n");
     printf("t  -  Texture rendering mode\n");
     printf("b  -  Show or hide boundary\n");
+    printf("r  -  Write the residuals of the forms to JSON\n");
     printf("?  -  Help Information\n");
     printf("esc - Quit\n");
 }
@@ -336,6 +340,11 @@ void keyBoard(unsigned char key, int x, int y)
         // Show or hide boundary
         g_show_boundary = !g_show_boundary;
         break;
+    case 'r':
+        // write the closedness and coclosedness residuals
+        g_mapper.write_residuals(g_residual_file.c_str());
+        std::cout << "residuals written to " << g_residual_file << std::endl;
+        break;
     case '?':
         help();
         break;
@@ -572,7 +581,6 @@ void calc_holo_1_form(const std::string &input_mesh)
     pM->read_m(input_mesh.c_str());
     g_meshes.push_back(pM);
 
-    std::srand((unsigned)time(NULL));
     if (!closed_mesh(pM))
     {
         M::CBoundary_ bnd(pM);
@@ -586,19 +594,18 @@ void calc_holo_1_form(const std::string &input_mesh)
         }
 
         size_t i = 0;
-        for (std::vector<M *>::iterator miter = g_meshes.begin(); miter != g_meshes.end(); miter++, i++)
+        for (i = 0; i < n; i++)
         {
-            M *pM = *miter;
-            g_mapper.set_mesh(pM);
+            g_mapper.set_mesh(g_meshes[i]);
+            g_mapper.exact_harmonic_form(i + 1);
+        }
 
-            if (i < n)
-            {
-                g_mapper.exact_harmonic_form(i + 1);
-            }
-            else
-            {
-                g_mapper.random_harmonic_form();
-            }
+        // closed forms dual to the tree-cotree generators, projected with one factorization
+        std::vector<M *> forms(g_meshes.begin() + n, g_meshes.end());
+        if (!forms.empty())
+        {
+            g_mapper.set_mesh(forms.front());
+            g_mapper.cohomology_basis(forms);
         }
 
         CBaseHolomorphicForm<M> holo(g_meshes);
@@ -658,10 +665,12 @@ void calc_holo_1_form(const std::string &input_mesh)
             M *pM = *iter;
             normalizeMesh(pM);
             computeNormal(pM);
-            g_mapper.set_mesh(pM);
-            g_mapper.random_harmonic_form();
         }
 
+        // closed forms dual to the tree-cotree generators, projected with one factorization
+        g_mapper.set_mesh(g_meshes.front());
+        g_mapper.cohomology_basis(g_meshes);
+
         CBaseHolomorphicForm<M> holo(g_meshes);
         holo.conjugate();
     }
@@ -679,22 +688,39 @@ int main(int argc, char *argv[])
 {
     if (argc < 3)
     {
-        printf("Usage: %s input.m input_open.m output_file_prefix\n", argv[0]);
+        printf("Usage: %s input.m input_open.m|- texture.bmp\n", argv[0]);
         return EXIT_FAILURE;
     }
 
     std::string input_mesh_name(argv[1]);
     if (!strutil::endsWith(input_mesh_name, ".m"))
     {
-        printf("Usage: %s input.m input_open.m output_file_prefix\n", argv[0]);
+        printf("Usage: %s input.m input_open.m|- texture.bmp\n", argv[0]);
         return EXIT_FAILURE;
     }
 
     g_domain_mesh = new CHodgeDecompositionMesh;
-    g_domain_mesh->read_m(argv[2]);
+    if (std::string(argv[2]) == "-")
+    {
+        // slice the input mesh along its cut graph in memory
+        CHodgeDecompositionMesh mesh;
+        mesh.read_m(input_mesh_name.c_str());
+
+        CHodgeDecomposition cutter;
+        cutter.set_mesh(&mesh);
+        cutter.cut_graph();
+
+        CMeshSlicer<CHodgeDecompositionMesh, CHodgeDecompositionMesh> slicer(&mesh);
+        slicer.slice(g_domain_mesh);
+    }
+    else
+    {
+        g_domain_mesh->read_m(argv[2]);
+    }
     normalizeMesh(g_domain_mesh);
     computeNormal(g_domain_mesh);
 
+    g_residual_file = input_mesh_name + ".residuals.json";
     calc_holo_1_form(input_mesh_name);
 
     // load texture
@@ -9,6 +9,9 @@
 #ifndef _DOMAIN_OPTIMAL_TRANSPORT_H_
 #define _DOMAIN_OPTIMAL_TRANSPORT_H_
 
+#include <ostream>
+#include <string>
+
 #include "Detri2Mesh.h"
 #include "OT.h"
 #include "OTMesh.h"
@@ -32,6 +35,16 @@ namespace MeshLib
 class CDomainOptimalTransport : public CBaseOT, public CDetri2Mesh
 {
   public:
+    /*! the methods of _solve */
+    enum
+    {
+        OT_GRADIENT_DESCEND = 0,
+        OT_NEWTON = 1,
+        OT_QUASI_NEWTON = 2,
+        /*! Newton's method, or L-BFGS for large meshes */
+        OT_OPTIMIZE = 3
+    };
+
     CDomainOptimalTransport(COMTMesh *pMesh);
 
     ~CDomainOptimalTransport();
@@ -39,13 +52,49 @@ class CDomainOptimalTransport : public CBaseOT, public CDetri2Mesh
     /*! initialize the potential function as quadratic
      */
     void _initialize(bool uniform);
-    /*! gradient descend
+
+    /*! initialize with the given target measure and weights, addressed by the vertex index, the vertex uv are
+     *  normalized already, e.g. a level of the multiscale solver
+     */
+    void _initialize(std::vector<double> &target_area, std::vector<double> &weight);
+
+    /*! warm start the weights by the multiscale solver, call after _initialize(bool). The OT of coarser subsamples of
+     *  the sites is solved from the coarsest one, and its weights are interpolated to the next level. Opt-in, the
+     *  solvers start from zero weights. On meshes whose vertex density matches the target, e.g. data/girl.m, zero
+     *  weights are the better start. Afterwards the empty rows of the hessian are filled, see m_fill_empty_rows
+     */
+    void _multiscale_initialize();
+    /*! gradient descend, one step, the Weighted Delaunay mesh is updated in place or regenerated
+     */
+    void __gradient_descend();
+
+    /*! Newton's method, one step, the Weighted Delaunay mesh is updated in place or regenerated
      */
-    void __gradient_descend(COMTMesh *pInput, COMTMesh *&pOutput);
+    void __newton();
 
-    /*! Newton's method
+    /*! L-BFGS, one step, only the gradient and the power diagram are used
      */
-    void __newton(COMTMesh *pInput, COMTMesh *&pOutput);
+    void __quasi_newton();
+
+    /*! one step of Newton's method, or of L-BFGS if the hessian does not fit, see _use_newton()
+     */
+    void __optimize();
+
+    /*! iterate the method until the maximal relative error is at most the tolerance, or up to max_iterations counted
+     *  from the initialization, including the ones before a resumed checkpoint. Every iteration is logged as a CSV
+     *  row, or as a JSON line, and the weights are saved to checkpoint_file() every checkpoint_interval() iterations.
+     *  Returns whether the tolerance is reached.
+     */
+    bool _solve(int method, double tolerance, int max_iterations, std::ostream *log = NULL, bool json = false);
+
+    /*! save the weights and the iteration count to a binary file: "OTW1", the int32 number of weights and
+     *  iteration, then the doubles addressed by the vertex index
+     */
+    bool _save_weights(const std::string &filename);
+
+    /*! load the weights saved by _save_weights for the same mesh, and regenerate the WDT
+     */
+    bool _load_weights(const std::string &filename);
 
     void set_target_measure_to_uniform();
 
@@ -65,10 +114,116 @@ class CDomainOptimalTransport : public CBaseOT, public CDetri2Mesh
         return m_pMesh;
     };
 
+    // update the Weighted Delaunay Triangulation by flips, instead of generating it again
+    bool &incremental()
+    {
+        return m_incremental;
+    };
+
+    // number of step lengths t, t/2, ..., evaluated concurrently by the damping, 1 for one at a time
+    int &line_search_candidates()
+    {
+        return m_line_search_candidates;
+    };
+
+    // skip the candidate step lengths whose linearized dual cell areas are far below zero, a heuristic: the
+    // areas are not linear in the step length, so it may still skip a step length the damping would accept
+    bool &line_search_precheck()
+    {
+        return m_line_search_precheck;
+    };
+
+    // the weights are saved by _solve every checkpoint_interval iterations, if the file name is not empty
+    std::string &checkpoint_file()
+    {
+        return m_checkpoint_file;
+    };
+
+    int &checkpoint_interval()
+    {
+        return m_checkpoint_interval;
+    };
+
+    // number of the iterations since the initialization, or the resumed checkpoint
+    int &iteration()
+    {
+        return m_iteration;
+    };
+
+    // the step length accepted by the last damping, and the number of the step lengths it rejected
+    double step_length()
+    {
+        return m_step_length;
+    };
+
+    int rejected_steps()
+    {
+        return m_rejected_steps;
+    };
+
+    // ratio of the numbers of sites of two consecutive levels of the multiscale solver, as the rounds of BRIO
+    double &multiscale_ratio()
+    {
+        return m_multiscale_ratio;
+    };
+
+    // the coarsest level of the multiscale solver has at least this number of sites
+    int &multiscale_min_size()
+    {
+        return m_multiscale_min_size;
+    };
+
+    // a coarse level is solved by Newton's method up to this maximal relative error, or up to multiscale_max_steps
+    double &multiscale_tolerance()
+    {
+        return m_multiscale_tolerance;
+    };
+
+    int &multiscale_max_steps()
+    {
+        return m_multiscale_max_steps;
+    };
+
   public:
     double total_target_area = 0.0;
 
   protected:
+    /*! damping iteration along the update direction, from the given step length,
+     *  with descent, the step is also halved until the energy decreases along the whole step,
+     *  return the accepted step length
+     */
+    double __damping(double step_length, bool descent = false);
+
+    /*! damping by the concurrent line search, each candidate step length has its own triangulation
+     */
+    double __line_search(double step_length, bool descent = false);
+
+    /*! the energy is non-increasing along the update direction at the current weights
+     */
+    bool __descending();
+
+    /*! set the weights and convert the WDT to the mesh. The missing points are inserted, otherwise the weights are
+     *  scaled toward zero by halves
+     */
+    void __set_weights(std::vector<double> &weight);
+    /*! insert the missing points of the weighted Delaunay triangulation, m_state.weight is updated */
+    bool __detri2_repair_WDT(detri2::Triangulation *pTr);
+
+    /*! the nearest one of the sites order[0], ..., order[m - 1] to every vertex, as its position j in the order,
+     *  by Dijkstra over the uv edge lengths of the base mesh
+     */
+    void __nearest_sites(std::vector<int> &order, int m, std::vector<int> &site);
+
+    /*! interpolate the weights of a level of the multiscale solver to the sites order[0], ..., order[m - 1] of the
+     *  next one, site is the nearest site of this level to every point
+     */
+    void __interpolate_weights(std::vector<MeshLib::CPoint> &ptlist, std::vector<int> &order, std::vector<int> &site,
+                               int m, std::vector<double> &weight);
+
+    /*! linearized change of the dual cell areas along the update direction, H * d
+     */
+    void __linearized_area_change(std::vector<double> &area_change);
+
     // triangle mesh for the Weighted Delaunay Triangulation
     COMTMesh *m_pWDT = NULL;
 
@@ -77,6 +232,30 @@ class CDomainOptimalTransport : public CBaseOT, public CDetri2Mesh
 
     // triangulation for the Weighted Delaunay
     detri2::Triangulation *m_outputTr = NULL;
+
+    // keep m_outputTr alive, and update it by flips when the weights change
+    bool m_incremental = false;
+
+    // number of the candidate step lengths of the line search
+    int m_line_search_candidates = 1;
+
+    // pre-check the candidates by the linearized dual cell areas
+    bool m_line_search_precheck = false;
+
+    // checkpoints and the iteration count of _solve
+    std::string m_checkpoint_file;
+    int m_checkpoint_interval = 10;
+    int m_iteration = 0;
+
+    // the last damping
+    double m_step_length = 0;
+    int m_rejected_steps = 0;
+
+    // levels of the multiscale solver
+    double m_multiscale_ratio = 0.125;
+    int m_multiscale_min_size = 1000;
+    double m_multiscale_tolerance = 0.01;
+    int m_multiscale_max_steps = 20;
 };
 
 } // namespace MeshLib
@@ -36,27 +36,52 @@ class CDetri2Mesh
   protected:
     /*! compute Weighted Delaunay and Power Voronoi
      */
-    bool __detri2_WDT(COMTMesh *mesh, detri2::Triangulation **outputTr);
+    bool __detri2_WDT(COMTMesh *mesh, std::vector<double> &weights, detri2::Triangulation **outputTr);
+
+    /*! update Weighted Delaunay and Power Voronoi by flips
+     */
+    bool __detri2_remesh_WDT(COMTMesh *mesh, std::vector<double> &weights, detri2::Triangulation *&outputTr);
+
+    /*! insert the missing points with the smallest weights which keep them, the weights are updated
+     */
+    bool __detri2_insert_missing_WDT(std::vector<double> &weights, detri2::Triangulation *outputTr);
 
     /*! generate background triangulation
      */
     void __detri2_generate_disk(detri2::Triangulation *&domainTr, double &total_target_area);
 
-    /*! convert Detri2 triangulation to Mesh
+    /*! convert Detri2 triangulation to Mesh, or update the mesh in place, return true if the mesh is regenerated
+     */
+    bool __detri2_to_mesh(detri2::Triangulation *outputTr, detri2::Triangulation *domainTr, COMTMesh *&pMesh);
+
+    /*! index the edges of a regenerated mesh, by the vertex indices id - 1
+     */
+    void __detri2_index_edges(COMTMesh *pMesh);
+
+    /*! edges of the mesh, in the order of the edge index
      */
-    void __detri2_to_mesh(detri2::Triangulation *outputTr, detri2::Triangulation *domainTr, COMTMesh *&pMesh);
+    std::vector<COMTMesh::CEdge *> m_edges;
+    /*! the neighbors of vertex i are m_vertex_neighbor[m_vertex_offset[i]] to m_vertex_neighbor[m_vertex_offset[i + 1] -
+     * 1], the edges to them are in m_vertex_edge
+     */
+    std::vector<int> m_vertex_offset;
+    std::vector<int> m_vertex_neighbor;
+    std::vector<int> m_vertex_edge;
+    /*! dual length of each edge, in the order of the edge index
+     */
+    std::vector<double> m_dual_lengths;
 };
 
 /*
         generate power delaunay triangulation, if there are missing points return false; if there is no missing point,
    return true
 */
-inline bool CDetri2Mesh::__detri2_WDT(COMTMesh *pMesh,                 // input mesh, the vertex weight is set
+inline bool CDetri2Mesh::__detri2_WDT(COMTMesh *pMesh,                 // input mesh, the vertex uv is set
+                                      std::vector<double> &weights,    // vertex weights, in the vertex order
                                       detri2::Triangulation **outputTr // output triangulation,
 )
 {
     std::vector<MeshLib::CPoint> ptlist;
-    std::vector<double> input_weights;
     std::vector<int> missing_point_list;
     std::vector<std::pair<int, int>> boundary_edge_list;
 
@@ -66,11 +91,37 @@ inline bool CDetri2Mesh::__detri2_WDT(COMTMesh *pMesh,                 // input
         // CPoint p = pv->point();
         CPoint p = CPoint(pv->uv()[0], pv->uv()[1], 0);
         ptlist.push_back(p);
-        double weight = pv->weight();
-        input_weights.push_back(weight);
     }
 
-    generate_wdt(ptlist, input_weights, boundary_edge_list, false, outputTr, missing_point_list);
+    generate_wdt(ptlist, weights, boundary_edge_list, false, outputTr, missing_point_list);
+
+    if (!missing_point_list.empty())
+    {
+        std::cout << "Missing Point" << std::endl;
+        return false;
+    }
+
+    return true;
+};
+
+/*
+        update the power delaunay triangulation in place, only the stars of the vertices whose weight changed are
+   flipped, if there are missing points return false; if the flips fail, generate the triangulation again
+*/
+inline bool CDetri2Mesh::__detri2_remesh_WDT(COMTMesh *pMesh,                 // input mesh, the vertex uv is set
+                                             std::vector<double> &weights,    // vertex weights, in the vertex order
+                                             detri2::Triangulation *&outputTr // input and output triangulation
+)
+{
+    std::vector<int> missing_point_list;
+
+    if (!remesh_wdt(outputTr, &weights, false, &missing_point_list, NULL))
+    {
+        std::cout << "Flips Failed, Regenerate WDT" << std::endl;
+        delete outputTr;
+        outputTr = NULL;
+        return __detri2_WDT(pMesh, weights, &outputTr);
+    }
 
     if (!missing_point_list.empty())
     {
@@ -81,6 +132,33 @@ inline bool CDetri2Mesh::__detri2_WDT(COMTMesh *pMesh,                 // input
     return true;
 };
 
+/*
+        insert the missing points of the power delaunay triangulation, each one with the smallest weight which keeps
+   it, its cell is tiny; return false if points are still missing, or the flips fail
+*/
+inline bool CDetri2Mesh::__detri2_insert_missing_WDT(std::vector<double> &weights,   // vertex weights, updated
+                                                     detri2::Triangulation *outputTr // input and output triangulation
+)
+{
+    std::vector<int> missing_point_list;
+    std::vector<double> updated_weights;
+
+    // an inserted point may make an earlier one redundant again
+    size_t missing = weights.size();
+    while (true)
+    {
+        bool regular = remesh_wdt(outputTr, &weights, true, &missing_point_list, &updated_weights);
+        weights = updated_weights;
+        if (!regular)
+            return false;
+        if (missing_point_list.empty())
+            return true;
+        if (missing_point_list.size() >= missing)
+            return false;
+        missing = missing_point_list.size();
+    }
+};
+
 /*
         generate the background weighted Delaunay triangulation,
         generate a disk with raidus one
@@ -138,61 +216,117 @@ inline void CDetri2Mesh::__detri2_generate_disk(detri2::Triangulation *&domainTr
         convert weighted Delaunay triangulation, power diagram to a mesh
         with edge length, dual length
         vertex dual cell, dual center, and dual cell area
+        if the mesh has the same connectivity as the triangulation, it is updated in place,
+        otherwise it is regenerated, and true is returned
 */
-inline void CDetri2Mesh::__detri2_to_mesh(detri2::Triangulation *outputTr, detri2::Triangulation *domainTr,
+inline bool CDetri2Mesh::__detri2_to_mesh(detri2::Triangulation *outputTr, detri2::Triangulation *domainTr,
                                           COMTMesh *&pWDT)
 {
-    // if the output mesh pointer is non-empty, delete the old mesh
-    if (pWDT != NULL)
-        delete pWDT;
+    bool regenerated = false;
+    if (pWDT == NULL || !update_Detri2_to_OMTmesh(outputTr, pWDT))
+    {
+        // if the output mesh pointer is non-empty, delete the old mesh
+        if (pWDT != NULL)
+            delete pWDT;
 
-    // generate a new mesh
-    pWDT = new COMTMesh;
-    // convert WDT to the mesh
-    export_Detri2_to_OMTmesh(outputTr, pWDT);
-    pWDT->labelBoundary();
-    // pWDT->write_m("Debug.m");
+        // generate a new mesh
+        pWDT = new COMTMesh;
+        // convert WDT to the mesh
+        export_Detri2_to_OMTmesh(outputTr, pWDT);
+        pWDT->labelBoundary();
+        // pWDT->write_m("Debug.m");
+        regenerated = true;
+    }
+    if (regenerated || m_edges.empty())
+        __detri2_index_edges(pWDT);
 
     get_voronoi_vertices(outputTr, domainTr);
-    // get vertex dual cell, dual centerand dual area
+    // get all vertex dual cells, dual centers, dual areas and dual edge lengths at once
+    std::vector<int> cell_offsets;
+    std::vector<CPoint> cell_points;
+    std::vector<double> cell_areas;
+    std::vector<CPoint> cell_centers;
+    std::vector<std::pair<int, int>> edge_list;
+    std::vector<double> dual_lengths;
+    get_voronoi_diagram(outputTr, cell_offsets, cell_points, cell_areas, cell_centers, edge_list, dual_lengths);
+
     for (COMTMesh::MeshVertexIterator viter(pWDT); !viter.end(); viter++)
     {
         COMTMesh::CVertex *pv = *viter;
-        double area;
-        CPoint center;
-        std::vector<MeshLib::CPoint> ptlist;
-        get_voronoi_cell(outputTr, pv->id(), ptlist, area, center);
-        pv->dual_area() = area;
-        pv->dual_center() = center;
-
-        for (size_t i = 0; i < ptlist.size(); i++)
+        int i = pv->id() - 1;
+        pv->dual_area() = cell_areas[i];
+        pv->dual_center() = cell_centers[i];
+
+        int first = cell_offsets[i];
+        int n = cell_offsets[i + 1] - first;
+        pv->dual_cell().edges().clear();
+        pv->dual_cell().edges().reserve(n);
+        for (int j = 0; j < n; j++)
         {
-            CPoint start = ptlist[i];
-            CPoint end = ptlist[(i + 1) % ptlist.size()];
-            CSegment3D s(start, end);
+            CSegment3D s(cell_points[first + j], cell_points[first + (j + 1) % n]);
             pv->dual_cell().add(s);
         }
-        // break;
-        // std::cout << "Voronoi cell " << pv->index() << " " << ptlist.size() << " " << area << std::endl;
+    }
+    // get dual edge length through the edge index, the edges of the removed exterior triangles have none
+    m_dual_lengths.assign(m_edges.size(), 0);
+    for (size_t i = 0; i < edge_list.size(); i++)
+    {
+        int a = edge_list[i].first - 1;
+        int b = edge_list[i].second - 1;
+        for (int k = m_vertex_offset[a]; k < m_vertex_offset[a + 1]; k++)
+        {
+            if (m_vertex_neighbor[k] == b)
+            {
+                m_dual_lengths[m_vertex_edge[k]] = dual_lengths[i];
+                break;
+            }
+        }
     }
     // get edge length
-    for (COMTMesh::MeshEdgeIterator eiter(pWDT); !eiter.end(); eiter++)
+    for (size_t k = 0; k < m_edges.size(); k++)
     {
-        COMTMesh::CEdge *pe = *eiter;
+        COMTMesh::CEdge *pe = m_edges[k];
         COMTMesh::CVertex *pv1 = pWDT->edgeVertex1(pe);
         COMTMesh::CVertex *pv2 = pWDT->edgeVertex2(pe);
         // pe->length() = pWDT->edgeLength(pe);
         pe->length() = (pv1->uv() - pv2->uv()).norm();
+        pe->dual_length() = m_dual_lengths[k];
     }
-    // get dual edge length
+
+    return regenerated;
+};
+
+/*
+        index the edges of the mesh once it is regenerated, so that the dual edges of the triangulation, given by
+        their vertex indices, are found without searching the mesh
+*/
+inline void CDetri2Mesh::__detri2_index_edges(COMTMesh *pWDT)
+{
+    int nv = pWDT->numVertices();
+    m_edges.clear();
+    m_edges.reserve(pWDT->numEdges());
+    m_vertex_offset.assign(nv + 1, 0);
     for (COMTMesh::MeshEdgeIterator eiter(pWDT); !eiter.end(); eiter++)
     {
         COMTMesh::CEdge *pe = *eiter;
-        COMTMesh::CVertex *pv1 = pWDT->edgeVertex1(pe);
-        COMTMesh::CVertex *pv2 = pWDT->edgeVertex2(pe);
-        double length;
-        get_voronoi_edge(outputTr, pv1->id(), pv2->id(), length);
-        pe->dual_length() = length;
+        m_edges.push_back(pe);
+        m_vertex_offset[pWDT->edgeVertex1(pe)->id()]++;
+        m_vertex_offset[pWDT->edgeVertex2(pe)->id()]++;
+    }
+    for (int i = 0; i < nv; i++)
+        m_vertex_offset[i + 1] += m_vertex_offset[i];
+
+    std::vector<int> next(m_vertex_offset.begin(), m_vertex_offset.end() - 1);
+    m_vertex_neighbor.resize(m_vertex_offset[nv]);
+    m_vertex_edge.resize(m_vertex_offset[nv]);
+    for (size_t k = 0; k < m_edges.size(); k++)
+    {
+        int a = pWDT->edgeVertex1(m_edges[k])->id() - 1;
+        int b = pWDT->edgeVertex2(m_edges[k])->id() - 1;
+        m_vertex_neighbor[next[a]] = b;
+        m_vertex_edge[next[a]++] = (int)k;
+        m_vertex_neighbor[next[b]] = a;
+        m_vertex_edge[next[b]++] = (int)k;
     }
 };
 } // namespace MeshLib
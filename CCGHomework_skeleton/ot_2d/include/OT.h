@@ -9,6 +9,7 @@
 #ifndef _BASE_OT_H_
 #define _BASE_OT_H_
 
+#include <deque>
 #include <map>
 #include <vector>
 #include <Eigen/Eigen>
@@ -23,6 +24,96 @@ namespace MeshLib
         Optimal Transport
 
 --------------------------------------------------------------------------------------------------------------------------------------*/
+/*! \brief COTState class
+ *
+ *  per vertex data of the optimal transport, addressed by the vertex index,
+ *  it persists over the iterations, while the weighted Delaunay mesh may be regenerated
+ *
+ */
+class COTState
+{
+  public:
+    /*! allocate the data of n vertices */
+    void resize(int n)
+    {
+        weight.assign(n, 0);
+        target_area.assign(n, 0);
+        dual_area.assign(n, 0);
+        dual_center.assign(n, CPoint());
+        update_direction.assign(n, 0);
+    };
+
+    /*! number of vertices */
+    int size()
+    {
+        return (int)weight.size();
+    };
+
+  public:
+    /*! vertex weight */
+    std::vector<double> weight;
+    /*! vertex target area */
+    std::vector<double> target_area;
+    /*! vertex dual cell area */
+    std::vector<double> dual_area;
+    /*! vertex dual cell center */
+    std::vector<CPoint> dual_center;
+    /*! vertex update direction */
+    std::vector<double> update_direction;
+};
+
+/*! \brief COTHessian
+ *
+ *  Hessian of the OT energy, the last vertex is grounded, which makes it positive definite.
+ *  The AMD ordering and the symbolic factorization are kept while the sparsity pattern is unchanged.
+ */
+struct COTHessian
+{
+    /*! the grounded hessian, both triangles are stored */
+    Eigen::SparseMatrix<double> H;
+    /*! direct solver */
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Lower, Eigen::AMDOrdering<int>> ldlt;
+    /*! sparsity pattern of the analyzed hessian, outer and inner indices */
+    std::vector<int> outer;
+    std::vector<int> inner;
+    /*! the symbolic factorization of ldlt is valid for the pattern */
+    bool analyzed = false;
+};
+
+/*! \brief COTLBFGS
+ *
+ *  History of the limited memory BFGS over the vertex weights, the pairs of the weight and the gradient changes,
+ *  s = w_{k+1} - w_k and y = g_{k+1} - g_k, newest at the back. Only O(m n) memory for the history length m.
+ */
+struct COTLBFGS
+{
+    /*! weight changes */
+    std::deque<std::vector<double>> s;
+    /*! gradient changes */
+    std::deque<std::vector<double>> y;
+    /*! 1 / (s . y) */
+    std::deque<double> rho;
+    /*! weight and gradient of the previous iteration */
+    std::vector<double> weight;
+    std::vector<double> gradient;
+    /*! initial inverse hessian, a scalar, it starts as the step of the gradient descend */
+    double gamma = 0.1;
+    /*! the last accepted step length */
+    double step = 0.5;
+
+    /*! drop the history, e.g. when the target measure changes */
+    void clear()
+    {
+        s.clear();
+        y.clear();
+        rho.clear();
+        weight.clear();
+        gradient.clear();
+        gamma = 0.1;
+        step = 0.5;
+    };
+};
+
 /*! \brief CBaseOT class
  *
  *  base class for optimal transport
@@ -31,6 +122,15 @@ namespace MeshLib
 class CBaseOT
 {
   public:
+    /*! preconditioners of the conjugate gradient */
+    enum
+    {
+        /*! the inverse diagonal */
+        PCG_JACOBI = 0,
+        /*! incomplete Cholesky factorization */
+        PCG_INCOMPLETE_CHOLESKY = 1
+    };
+
     CBaseOT(COMTMesh *pMesh)
     {
         m_pMesh = pMesh;
@@ -50,21 +150,82 @@ class CBaseOT
     virtual void _normalize_uv(COMTMesh *pMesh);
     /*! compute the maximal relative error */
     virtual void _compute_error(COMTMesh *pMesh);
+    /*! maximal relative error of the dual areas in the state */
+    double _max_error();
+    /*! sum of the squared errors of the dual areas in the state, the L2 error of _compute_error */
+    double _l2_error();
     /*! set target are */
     virtual void _set_target_measure(COMTMesh *&pMesh, double total_target_area = PI, bool uniform = false);
     /*! initialize the mapping, idendity*/
     virtual void _initialize(COMTMesh *pChull){};
-    /*! copy different attributes from input mesh to the output mesh */
-    void _copy_mesh(COMTMesh *pInput, COMTMesh *pOutput);
+    /*! copy the state to the vertices of the weighted Delaunay mesh and read its dual cells back,
+     *  the color and normal of the base mesh are copied only if the mesh is regenerated */
+    void _update_mesh(COMTMesh *pMesh, bool regenerated);
+
+    /*! per vertex data, addressed by the vertex index */
+    COTState &state()
+    {
+        return m_state;
+    };
+
+    /*! the hessian is solved by LDLT up to this size, and by preconditioned conjugate gradient above */
+    int &direct_solver_max_size()
+    {
+        return m_direct_solver_max_size;
+    };
+
+    /*! preconditioner of the conjugate gradient, PCG_INCOMPLETE_CHOLESKY by default */
+    int &pcg_preconditioner()
+    {
+        return m_pcg_preconditioner;
+    };
+
+    /*! relative residual of the conjugate gradient */
+    double &pcg_tolerance()
+    {
+        return m_pcg_tolerance;
+    };
+
+    /*! number of the (s, y) pairs kept by L-BFGS */
+    int &lbfgs_history()
+    {
+        return m_lbfgs_history;
+    };
+
+    /*! Newton's method is used up to this size, if the hessian fits into the available memory, L-BFGS above */
+    int &newton_max_size()
+    {
+        return m_newton_max_size;
+    };
+
+    /*! whether Newton's method is used for the current mesh, otherwise L-BFGS */
+    bool _use_newton();
 
   protected:
     COMTMesh *m_pMesh;
-    /*! compute the hessian matrix, from edge length and dual edge length, and vertex index */
+    /*! per vertex data, addressed by the vertex index */
+    COTState m_state;
+    /*! grounded hessian and its factorization */
+    COTHessian m_hessian;
+    /*! solver options of the hessian */
+    int m_direct_solver_max_size = 250000;
+    int m_pcg_preconditioner = PCG_INCOMPLETE_CHOLESKY;
+    double m_pcg_tolerance = 1e-10;
+    /*! L-BFGS history, and the automatic choice of the method */
+    COTLBFGS m_lbfgs;
+    int m_lbfgs_history = 10;
+    int m_newton_max_size = 2000000;
+    /*! give the empty rows of the hessian the mean diagonal, set by the multiscale warm start only */
+    bool m_fill_empty_rows = false;
+    /*! compute the hessian matrix from the edges, with edge length and dual edge length, and vertex index,
+     *  the last vertex is grounded */
     void __compute_hessian_matrix(COMTMesh &mesh, Eigen::SparseMatrix<double> &hessian);
     /*! compute the vertex update direction using Newton's method */
     void __update_direction(COMTMesh *m_pMesh);
-    /*! use Eigen to solve a linear system */
-    bool __solve(Eigen::SparseMatrix<double> &A, Eigen::VectorXd &b, Eigen::VectorXd &result);
+    /*! solve the grounded hessian, the direct solver reuses its symbolic factorization if the pattern is unchanged */
+    bool __solve(Eigen::VectorXd &b, Eigen::VectorXd &result);
+    /*! compute the vertex update direction using L-BFGS, from the gradient history */
+    void __lbfgs_direction();
     /*! reindex all the vertices, starting from zero */
     void index(COMTMesh *pMesh);
     // list of vertex ids for random access
@@ -6,6 +6,21 @@
  *   Class for Planar Optimal Transportation, Semi-Discrete Algorithm
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
 #include <Eigen/Eigen>
 
 #include "CDomainOptimalTransport.h"
@@ -29,6 +44,7 @@ CDomainOptimalTransport ::~CDomainOptimalTransport()
 {
     delete m_domainTr;
     delete m_outputTr;
+    delete m_pWDT;
 }
 
 // initialize the potential function as quadratic
@@ -37,6 +53,16 @@ void CDomainOptimalTransport::set_target_measure_to_uniform()
 {
     std::cout << "setting target measure to 1/n" << std::endl;
     _set_target_measure(m_pMesh, total_target_area, true);
+
+    for (int i = 0; i < m_state.size(); i++)
+    {
+        m_state.target_area[i] = V[i]->target_area();
+    }
+    // the gradient changes with the target measure
+    m_lbfgs.clear();
+    m_iteration = 0;
+    if (m_pWDT != NULL)
+        _update_mesh(m_pWDT, false);
 }
 
 void CDomainOptimalTransport::find_singularities(COMTMesh *pInput)
@@ -90,203 +116,696 @@ void CDomainOptimalTransport::_initialize(bool uniform)
         pv->weight() = 0;
     }
 
+    /*! initialize the state, addressed by the vertex index */
+    m_state.resize(m_pMesh->numVertices());
+    for (COMTMesh::MeshVertexIterator viter(m_pMesh); !viter.end(); viter++)
+    {
+        COMTMesh::CVertex *pv = *viter;
+        m_state.weight[pv->index()] = pv->weight();
+        m_state.target_area[pv->index()] = pv->target_area();
+    }
+    m_lbfgs.clear();
+    m_iteration = 0;
+
     /*! normalize the vertex uv coordinates */
     _normalize_uv(m_pMesh);
 
     /*! Compute Weighted Delaunay of Base Mesh Vertices */
-    __detri2_WDT(m_pMesh, &m_outputTr);
+    __detri2_WDT(m_pMesh, m_state.weight, &m_outputTr);
 
     /*! convert the Weighted Delaunay Triangulation to a mesh */
-    __detri2_to_mesh(m_outputTr, m_domainTr, m_pWDT);
+    bool regenerated = __detri2_to_mesh(m_outputTr, m_domainTr, m_pWDT);
 
-    /*! copy vertex_weight, vertex_target_area, vertex_index from base mesh to the Weighted Delaunay Triangulation Mesh
+    /*! copy vertex_weight, vertex_target_area, vertex_index to the Weighted Delaunay Triangulation Mesh
      */
-    _copy_mesh(m_pMesh, m_pWDT);
+    _update_mesh(m_pWDT, regenerated);
 };
 
-/*! Gradient Descende method to compute the OT Map */
-void CDomainOptimalTransport::__gradient_descend(
-    COMTMesh *pInput,  // input  mesh, the vertex->target_area, dual_area need to be set
-    COMTMesh *&pOutput // output mesh, the vertex->target_area, dual_area, dual_cell, uv (dual cell center) have been
-                       // set, the connectivity is updated
-)
+/*! initialize with the given target measure and weights, the uv are normalized already */
+void CDomainOptimalTransport::_initialize(std::vector<double> &target_area, std::vector<double> &weight)
 {
+    /*! compute the domain triangulation, a convex polygon */
+    __detri2_generate_disk(m_domainTr, total_target_area);
 
-    // #pragma omp parallel for
-    //     for (int i = 0; i < V.size(); ++i)
-    //     {
-    //         COMTMesh::CVertex *pv = V.at(i);
-    //         // for (int i = 0; i < m_pMesh->numVertices(); ++i)
-    //         // {
-    //         //     int id = ids[i];
-    //         //     COMTMesh::CVertex *pv = m_pMesh->idVertex(id);
-    //         double grad = -(pv->target_area() - pv->dual_area());
-    //         pv->update_direction() = grad;
-    //     }
+    /*! initialize the vertex index, starting from zero */
+    index(m_pMesh);
 
-    /*! compute the gradient, which equals to (target_area - dual_area) */
-    for (COMTMesh::MeshVertexIterator viter(pInput); !viter.end(); viter++)
+    for (COMTMesh::MeshVertexIterator viter(m_pMesh); !viter.end(); viter++)
     {
         COMTMesh::CVertex *pv = *viter;
-        // to compute the gradient
-        double grad = -(pv->target_area() - pv->dual_area());
-        pv->update_direction() = grad;
+        ids[pv->index()] = pv->id();
     }
 
-    /*! set initial step length */
-    double step_length = 0.1;
-    /*! pointer to the output WDT */
-    detri2::Triangulation *pTr = NULL;
-    /*! temparary mesh */
-    COMTMesh *pMesh = NULL;
+    /*! initialize the state, addressed by the vertex index */
+    m_state.resize(m_pMesh->numVertices());
+    for (COMTMesh::MeshVertexIterator viter(m_pMesh); !viter.end(); viter++)
+    {
+        COMTMesh::CVertex *pv = *viter;
+        pv->target_area() = target_area[pv->index()];
+        m_state.target_area[pv->index()] = pv->target_area();
+    }
+    m_lbfgs.clear();
+    m_iteration = 0;
 
-    /*! damping iteration */
-    while (true)
+    /*! Compute Weighted Delaunay of Base Mesh Vertices, and convert it to a mesh */
+    __set_weights(weight);
+};
+
+/*! warm start by the multiscale solver */
+void CDomainOptimalTransport::_multiscale_initialize()
+{
+    int n = m_state.size();
+
+    /*! the levels are the prefixes of the BRIO order, n * ratio^k sites, coarsest first. The boundary vertices
+     *  are on all the levels, their weights can not be extrapolated, the cells may fall out of the domain */
+    std::vector<MeshLib::CPoint> ptlist(n);
+    for (int i = 0; i < n; i++)
+    {
+        ptlist[i] = CPoint(V[i]->uv()[0], V[i]->uv()[1], 0);
+    }
+    std::vector<int> order;
+    get_brio_order(ptlist, m_multiscale_ratio, order);
+    auto boundary_end = std::stable_partition(order.begin(), order.end(), [this](int i) { return V[i]->boundary(); });
+    int boundary_size = (int)(boundary_end - order.begin());
+
+    std::vector<int> sizes;
+    for (int m = (int)(n * m_multiscale_ratio); m >= m_multiscale_min_size && m >= boundary_size && m < n;
+         m = (int)(m * m_multiscale_ratio))
     {
+        sizes.push_back(m);
+    }
+    std::reverse(sizes.begin(), sizes.end());
+    sizes.push_back(n);
 
-        // #pragma omp parallel for
-        //         for (int i = 0; i < V.size(); ++i)
-        //         {
-        //             COMTMesh::CVertex *pv = V.at(i);
-        //             // for (int i = 0; i < m_pMesh->numVertices(); ++i)
-        //             // {
-        //             //     int id = ids[i];
-        //             //     COMTMesh::CVertex *pv = m_pMesh->idVertex(id);
-        //             pv->weight() -= step_length * pv->update_direction();
-        //         }
+    /*! the weights of the sites of the current level, in the order */
+    std::vector<double> weight(sizes[0], 0.0);
+    for (size_t level = 0; level + 1 < sizes.size(); level++)
+    {
+        int m = sizes[level];
+        auto t0 = std::chrono::steady_clock::now();
+
+        /*! the target measure of a site collects the target measure of the vertices nearest to it */
+        std::vector<int> site;
+        __nearest_sites(order, m, site);
+        std::vector<double> target_area(m, 0.0);
+        for (int i = 0; i < n; i++)
+        {
+            target_area[site[i]] += m_state.target_area[i];
+        }
 
-        // update the vertex weight
-        for (COMTMesh::MeshVertexIterator viter(pInput); !viter.end(); viter++)
+        COMTMesh level_mesh;
+        for (int j = 0; j < m; j++)
         {
-            COMTMesh::CVertex *pv = *viter;
-            pv->weight() -= step_length * pv->update_direction();
+            COMTMesh::CVertex *pv = level_mesh.createVertex(j + 1);
+            pv->uv() = V[order[j]]->uv();
+            pv->rgb() = V[order[j]]->rgb();
+            pv->normal() = V[order[j]]->normal();
         }
 
-        // compute Weighted Delaunay Triangulation
-        if (!__detri2_WDT(pInput, &pTr))
+        CDomainOptimalTransport level_ot(&level_mesh);
+        level_ot.incremental() = m_incremental;
+        level_ot.line_search_candidates() = m_line_search_candidates;
+        level_ot.m_fill_empty_rows = true;
+        level_ot._initialize(target_area, weight);
+
+        int steps = 0;
+        while (steps < m_multiscale_max_steps && level_ot._max_error() > m_multiscale_tolerance)
         {
+            level_ot.__newton();
+            steps++;
+        }
 
-            // #pragma omp parallel for
-            //             for (int i = 0; i < V.size(); ++i)
-            //             {
-            //                 COMTMesh::CVertex *pv = V.at(i);
-            //                 // for (int i = 0; i < m_pMesh->numVertices(); ++i)
-            //                 // {
-            //                 //     int id = ids[i];
-            //                 //     COMTMesh::CVertex *pv = m_pMesh->idVertex(id);
-            //                 pv->weight() += step_length * pv->update_direction();
-            //             }
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << "multiscale level " << level << ": " << m << " sites, " << steps
+                  << " Newton steps, max relative error " << level_ot._max_error() << ", time "
+                  << std::chrono::duration<double>(t1 - t0).count() << "s" << std::endl;
 
-            // if there are missing points,
-            // roll back the vertex weight
-            for (COMTMesh::MeshVertexIterator viter(pInput); !viter.end(); viter++)
-            {
-                COMTMesh::CVertex *pv = *viter;
-                pv->weight() += step_length * pv->update_direction();
-            }
+        level_ot.__interpolate_weights(ptlist, order, site, sizes[level + 1], weight);
+    }
 
-            delete pTr;
-            pTr = NULL;
-            // reduce the step length by half
-            step_length /= 2.0;
-            // try again
+    std::vector<double> fine_weight(n);
+    for (int j = 0; j < n; j++)
+    {
+        fine_weight[order[j]] = weight[j];
+    }
+    m_fill_empty_rows = true;
+    __set_weights(fine_weight);
+    std::cout << "multiscale level " << sizes.size() - 1 << ": " << n << " sites, max relative error "
+              << _max_error() << std::endl;
+};
+
+/*! The weights of the sites order[0], ..., order[m - 1] of the next level. The weight of a new site x is linearly
+ *  interpolated in the triangle of the Weighted Delaunay mesh containing x, that is the Brenier potential
+ *  extended with the curvature of the identity map, and x is below the lifted triangle. The triangle is searched
+ *  in the two-ring of the nearest site, otherwise the potential is extended from the nearest site p alone,
+ *  w(x) = w(p) + 2 (p - c(p)) . (x - p), c(p) is the dual center of p.
+ */
+void CDomainOptimalTransport::__interpolate_weights(std::vector<MeshLib::CPoint> &ptlist, std::vector<int> &order,
+                                                    std::vector<int> &site, int m, std::vector<double> &weight)
+{
+    int k = m_state.size();
+    std::vector<COMTMesh::CVertex *> sites(k, NULL);
+    for (COMTMesh::MeshVertexIterator viter(m_pWDT); !viter.end(); viter++)
+    {
+        sites[(*viter)->index()] = *viter;
+    }
+
+    weight.resize(m);
+#pragma omp parallel for schedule(static)
+    for (int j = 0; j < m; j++)
+    {
+        if (j < k)
+        {
+            weight[j] = m_state.weight[j];
             continue;
         }
-        // no missing point
 
-        // convert the detri2::Triangulation to OMTMesh
-        // this will set the vertex->dual_area, vertex->dual_cell, vertex->dual_center;
-        // edge->length, edge->dual_length;
-        __detri2_to_mesh(pTr, m_domainTr, pMesh);
-        // copy vertex->target_carea, vertex->weight, vertex->index from the input mesh
-        // to the newly generated WDT mesh
-        _copy_mesh(pInput, pMesh);
+        CPoint x = ptlist[order[j]];
+        int nearest = site[order[j]];
+        CPoint p = ptlist[order[nearest]];
+        weight[j] = m_state.weight[nearest] + 2 * ((p - m_state.dual_center[nearest]) * (x - p));
+        if (sites[nearest] == NULL)
+            continue;
 
-        // if the old WDT pointer is nonempty, delete it
-        if (m_outputTr != NULL)
+        std::vector<COMTMesh::CVertex *> ring(1, sites[nearest]);
+        for (COMTMesh::VertexVertexIterator vviter(sites[nearest]); !vviter.end(); ++vviter)
         {
-            delete m_outputTr;
+            ring.push_back(*vviter);
         }
-        // update the WDT pointer by the current one
-        m_outputTr = pTr;
-        pOutput = pMesh;
+        bool found = false;
+        for (size_t r = 0; r < ring.size() && !found; r++)
+        {
+            for (COMTMesh::VertexFaceIterator vfiter(ring[r]); !vfiter.end(); ++vfiter)
+            {
+                COMTMesh::CHalfEdge *ph = m_pWDT->faceHalfedge(*vfiter);
+                int a = m_pWDT->halfedgeSource(ph)->index();
+                int b = m_pWDT->halfedgeTarget(ph)->index();
+                int c = m_pWDT->halfedgeTarget(m_pWDT->halfedgeNext(ph))->index();
+                CPoint pa = ptlist[order[a]], pb = ptlist[order[b]], pc = ptlist[order[c]];
+
+                double area = ((pb - pa) ^ (pc - pa))[2];
+                double la = ((pb - x) ^ (pc - x))[2] / area;
+                double lb = ((pc - x) ^ (pa - x))[2] / area;
+                double lc = 1.0 - la - lb;
+                if (la >= 0 && lb >= 0 && lc >= 0)
+                {
+                    weight[j] = la * m_state.weight[a] + lb * m_state.weight[b] + lc * m_state.weight[c];
+                    found = true;
+                    break;
+                }
+            }
+        }
+    }
+};
 
-        break;
+/*! Gradient Descende method to compute the OT Map */
+void CDomainOptimalTransport::__gradient_descend()
+{
+    /*! compute the gradient, which equals to (target_area - dual_area) */
+    for (int i = 0; i < m_state.size(); i++)
+    {
+        // to compute the gradient
+        double grad = -(m_state.target_area[i] - m_state.dual_area[i]);
+        m_state.update_direction[i] = grad;
     }
+
+    /*! set initial step length */
+    double step_length = 0.1;
+    __damping(step_length);
 };
 
 /*! Newton's method to compute the OT Map */
-void CDomainOptimalTransport::__newton(
-    COMTMesh *pInput, // input mesh, with vertex->target_area, vertex->dual_area, vertex->weight, vertex->index
-    COMTMesh *
-        &pOutput // output mesh, with copied vertex->target_area, vertex->index,
-                 // and updated vertex->dual_area, vertex->weight, vertex->dual_cell, vertex->dual_center, connectivity
-)
+void CDomainOptimalTransport::__newton()
 {
     /*! Use Newton's method to compute the update_direction */
-    __update_direction(pInput);
+    __update_direction(m_pWDT);
 
     /*! set initial step length */
     // double step_length = 1.0;
     double step_length = 0.5;
+    __damping(step_length);
+};
+
+/*! L-BFGS to compute the OT Map */
+void CDomainOptimalTransport::__quasi_newton()
+{
+    /*! Use the L-BFGS history to compute the update_direction */
+    __lbfgs_direction();
+
+    /*! set initial step length, the direction is scaled by the inverse hessian approximation,
+     *  start from twice the last accepted step, which saves the triangulations with missing points */
+    double step_length = std::min(1.0, 2.0 * m_lbfgs.step);
+    m_lbfgs.step = __damping(step_length, true);
+};
+
+/*! Newton's method, or L-BFGS for large meshes */
+void CDomainOptimalTransport::__optimize()
+{
+    if (_use_newton())
+        __newton();
+    else
+        __quasi_newton();
+};
+
+/*! iterate until the tolerance, log every iteration and save the checkpoints */
+bool CDomainOptimalTransport::_solve(int method, double tolerance, int max_iterations, std::ostream *log, bool json)
+{
+    if (log != NULL && !json && m_iteration == 0)
+    {
+        *log << "iteration,max_error,l2_error,step_length,rejected_steps,time" << std::endl;
+    }
+
+    double max_error = _max_error();
+    while (m_iteration < max_iterations && max_error > tolerance)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        switch (method)
+        {
+        case OT_GRADIENT_DESCEND:
+            __gradient_descend();
+            break;
+        case OT_NEWTON:
+            __newton();
+            break;
+        case OT_QUASI_NEWTON:
+            __quasi_newton();
+            break;
+        default:
+            __optimize();
+            break;
+        }
+        m_iteration++;
+        auto t1 = std::chrono::steady_clock::now();
+        double time = std::chrono::duration<double>(t1 - t0).count();
+
+        max_error = _max_error();
+        double l2_error = _l2_error();
+        std::cout << "iteration " << m_iteration << ": max relative error " << max_error << ", L2 error " << l2_error
+                  << ", step length " << m_step_length << ", rejected steps " << m_rejected_steps << ", time "
+                  << time << "s" << std::endl;
+
+        if (log != NULL)
+        {
+            if (json)
+            {
+                *log << "{\"iteration\": " << m_iteration << ", \"max_error\": " << max_error
+                     << ", \"l2_error\": " << l2_error << ", \"step_length\": " << m_step_length
+                     << ", \"rejected_steps\": " << m_rejected_steps << ", \"time\": " << time << "}" << std::endl;
+            }
+            else
+            {
+                *log << m_iteration << "," << max_error << "," << l2_error << "," << m_step_length << ","
+                     << m_rejected_steps << "," << time << std::endl;
+            }
+        }
+
+        if (!m_checkpoint_file.empty() && m_checkpoint_interval > 0 && m_iteration % m_checkpoint_interval == 0)
+        {
+            _save_weights(m_checkpoint_file);
+        }
+    }
+
+    if (!m_checkpoint_file.empty())
+    {
+        _save_weights(m_checkpoint_file);
+    }
+    return max_error <= tolerance;
+};
+
+/*! the file is written aside and renamed over the previous checkpoint, an interrupted write keeps it */
+bool CDomainOptimalTransport::_save_weights(const std::string &filename)
+{
+    std::string temp_name = filename + ".tmp";
+    {
+        std::ofstream file(temp_name.c_str(), std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "Error: cannot write the checkpoint " << temp_name << std::endl;
+            return false;
+        }
+        int32_t header[2] = {(int32_t)m_state.size(), (int32_t)m_iteration};
+        file.write("OTW1", 4);
+        file.write((const char *)header, sizeof(header));
+        file.write((const char *)m_state.weight.data(), m_state.size() * sizeof(double));
+        if (!file)
+        {
+            std::cerr << "Error: cannot write the checkpoint " << temp_name << std::endl;
+            return false;
+        }
+    }
+
+    /*! rename() replaces the previous checkpoint atomically on POSIX, but fails on Windows if it exists */
+#ifdef _WIN32
+    if (!MoveFileExA(temp_name.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+#else
+    if (std::rename(temp_name.c_str(), filename.c_str()) != 0)
+#endif
+    {
+        std::cerr << "Error: cannot rename the checkpoint to " << filename << std::endl;
+        return false;
+    }
+    return true;
+};
+
+/*! the weights are set by __set_weights, which inserts the points missing by the round off */
+bool CDomainOptimalTransport::_load_weights(const std::string &filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    char magic[4];
+    int32_t header[2];
+    file.read(magic, 4);
+    file.read((char *)header, sizeof(header));
+    if (!file || strncmp(magic, "OTW1", 4) != 0 || header[0] != m_state.size())
+    {
+        std::cerr << "Error: " << filename << " is not a checkpoint of this mesh" << std::endl;
+        return false;
+    }
+
+    std::vector<double> weight(m_state.size());
+    file.read((char *)weight.data(), weight.size() * sizeof(double));
+    if (!file)
+    {
+        std::cerr << "Error: the checkpoint " << filename << " is truncated" << std::endl;
+        return false;
+    }
+
+    m_lbfgs.clear();
+    __set_weights(weight);
+    m_iteration = header[1];
+    return true;
+};
+
+/*! move the weights along the update direction, halve the step length until no point is missing */
+double CDomainOptimalTransport::__damping(double step_length, bool descent)
+{
+    m_rejected_steps = 0;
+
+    /*! the flips update the single triangulation, the incremental damping stays sequential */
+    if (!m_incremental && m_line_search_candidates > 1)
+    {
+        m_step_length = __line_search(step_length, descent);
+        return m_step_length;
+    }
+
     /*! pointer to the output WDT */
     detri2::Triangulation *pTr = NULL;
-    /*! temparary mesh */
-    COMTMesh *pMesh = NULL;
 
     /*! damping iteration */
     while (true)
     {
-
         // update the vertex weight
-        for (COMTMesh::MeshVertexIterator viter(pInput); !viter.end(); viter++)
+        for (int i = 0; i < m_state.size(); i++)
         {
-            COMTMesh::CVertex *pv = *viter;
-            pv->weight() -= step_length * pv->update_direction();
+            m_state.weight[i] -= step_length * m_state.update_direction[i];
         }
 
-        // compute Weighted Delaunay Triangulation
-        bool success = __detri2_WDT(pInput, &pTr);
+        // compute Weighted Delaunay Triangulation, or update the current one
+        bool success = m_incremental ? __detri2_remesh_WDT(m_pMesh, m_state.weight, m_outputTr)
+                                     : __detri2_WDT(m_pMesh, m_state.weight, &pTr);
 
         if (!success)
         {
             // if there are missing points,
             // roll back the vertex weight
             // reduce the step length by half
-            for (COMTMesh::MeshVertexIterator viter(pInput); !viter.end(); viter++)
+            for (int i = 0; i < m_state.size(); i++)
             {
-                COMTMesh::CVertex *pv = *viter;
-                pv->weight() += step_length * pv->update_direction();
+                m_state.weight[i] += step_length * m_state.update_direction[i];
             }
 
             step_length /= 2.0;
+            m_rejected_steps++;
 
-            delete pTr;
-            pTr = NULL;
+            if (!m_incremental)
+            {
+                delete pTr;
+                pTr = NULL;
+            }
             continue;
         }
 
         // no missing point
+        if (m_incremental)
+            pTr = m_outputTr;
 
-        // convert the detri2::Triangulation to OMTMesh
+        // update the WDT mesh in place if its connectivity is unchanged, or regenerate it
         // this will set the vertex->dual_area, vertex->dual_cell, vertex->dual_center;
         // edge->length, edge->dual_length;
-        __detri2_to_mesh(pTr, m_domainTr, pMesh);
-        // copy vertex->target_area, vertex->weight, vertex->index from the input mesh
-        // to the newly generated WDT mesh
-        _copy_mesh(pInput, pMesh);
+        bool regenerated = __detri2_to_mesh(pTr, m_domainTr, m_pWDT);
+        // copy vertex->target_area, vertex->weight from the state to the WDT mesh,
+        // and vertex->index, vertex->rgb, vertex->normal if it is regenerated
+        _update_mesh(m_pWDT, regenerated);
 
         // if the old WDT pointer is nonempty, delete it
-        if (m_outputTr != NULL)
+        if (m_outputTr != NULL && m_outputTr != pTr)
         {
             delete m_outputTr;
         }
         // update the WDT pointer by the current one
         m_outputTr = pTr;
-        pOutput = pMesh;
+
+        // the step passed the minimum along the direction, roll back and halve
+        if (descent && !__descending())
+        {
+            for (int i = 0; i < m_state.size(); i++)
+            {
+                m_state.weight[i] += step_length * m_state.update_direction[i];
+            }
+            step_length /= 2.0;
+            m_rejected_steps++;
+            pTr = NULL;
+            continue;
+        }
 
         break;
     }
-}
+    m_step_length = step_length;
+    return step_length;
+};
+
+/*! the pre-check skips a candidate only if a linearized cell area is below -PRECHECK_MARGIN times the current one,
+ *  the areas are not linear in the step length, with a smaller margin feasible step lengths were skipped */
+static const double PRECHECK_MARGIN = 4.0;
+
+/*! evaluate the step lengths t, t/2, ..., concurrently, accept the largest one without missing point */
+double CDomainOptimalTransport::__line_search(double step_length, bool descent)
+{
+    int n = m_state.size();
+    int k = m_line_search_candidates;
+
+    /*! the linearized dual cell areas are A - t * H * d */
+    std::vector<double> area_change;
+    std::vector<double> dual_area = m_state.dual_area;
+    if (m_line_search_precheck)
+        __linearized_area_change(area_change);
+
+    while (true)
+    {
+        std::vector<double> steps(k);
+        std::vector<std::vector<double>> weights(k);
+        std::vector<detri2::Triangulation *> trs(k, (detri2::Triangulation *)NULL);
+        std::vector<int> evaluated(k, 1);
+        std::vector<int> feasible(k, 0);
+
+        for (int c = 0; c < k; c++)
+        {
+            steps[c] = (c == 0) ? step_length : steps[c - 1] / 2.0;
+            weights[c] = m_state.weight;
+            for (int i = 0; i < n; i++)
+            {
+                weights[c][i] -= steps[c] * m_state.update_direction[i];
+            }
+
+            // the smallest candidate is always evaluated, as the sequential damping would
+            if (m_line_search_precheck && c < k - 1)
+            {
+                for (int i = 0; i < n; i++)
+                {
+                    if (dual_area[i] - steps[c] * area_change[i] < -PRECHECK_MARGIN * dual_area[i])
+                    {
+                        evaluated[c] = 0;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // each candidate generates its own Weighted Delaunay Triangulation
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < k; c++)
+        {
+            if (evaluated[c])
+                feasible[c] = __detri2_WDT(m_pMesh, weights[c], &trs[c]) ? 1 : 0;
+        }
+
+        // the largest feasible step length, which also descends if required
+        std::vector<double> weight = m_state.weight;
+        int accepted = -1;
+        for (int c = 0; c < k && accepted < 0; c++)
+        {
+            if (!feasible[c])
+                continue;
+
+            m_state.weight = weights[c];
+            bool regenerated = __detri2_to_mesh(trs[c], m_domainTr, m_pWDT);
+            _update_mesh(m_pWDT, regenerated);
+
+            if (!descent || __descending())
+                accepted = c;
+        }
+
+        for (int c = 0; c < k; c++)
+        {
+            if (c != accepted)
+                delete trs[c];
+        }
+
+        if (accepted < 0)
+        {
+            // continue from the half of the smallest candidate
+            m_state.weight = weight;
+            step_length = steps[k - 1] / 2.0;
+            m_rejected_steps += k;
+            continue;
+        }
+
+        delete m_outputTr;
+        m_outputTr = trs[accepted];
+        m_rejected_steps += accepted;
+
+        return steps[accepted];
+    }
+};
+
+/*! the directional derivative of the energy at the current weights along -d, (target_area - dual_area) . d, is not
+ *  positive, the energy is convex, so it decreased along the whole step */
+bool CDomainOptimalTransport::__descending()
+{
+    double slope = 0;
+    for (int i = 0; i < m_state.size(); i++)
+    {
+        slope += (m_state.target_area[i] - m_state.dual_area[i]) * m_state.update_direction[i];
+    }
+    return slope <= 0;
+};
+
+/*! set the weights and generate the WDT, the missing points are inserted with the smallest weights which keep them,
+ *  if it fails, the weights are scaled toward zero by halves, zero weights give the Delaunay triangulation */
+void CDomainOptimalTransport::__set_weights(std::vector<double> &weight)
+{
+    double scale = 1.0;
+    while (true)
+    {
+        for (int i = 0; i < m_state.size(); i++)
+        {
+            m_state.weight[i] = scale * weight[i];
+        }
+
+        detri2::Triangulation *pTr = NULL;
+        if (__detri2_WDT(m_pMesh, m_state.weight, &pTr) || __detri2_repair_WDT(pTr))
+        {
+            delete m_outputTr;
+            m_outputTr = pTr;
+            break;
+        }
+        delete pTr;
+        scale = (scale < 1e-3) ? 0 : scale / 2.0;
+    }
+
+    for (COMTMesh::MeshVertexIterator viter(m_pMesh); !viter.end(); viter++)
+    {
+        COMTMesh::CVertex *pv = *viter;
+        pv->weight() = m_state.weight[pv->index()];
+    }
+
+    bool regenerated = __detri2_to_mesh(m_outputTr, m_domainTr, m_pWDT);
+    _update_mesh(m_pWDT, regenerated);
+};
+
+/*! insert the missing points, whose weights are raised until they appear, then enlarge their cells to
+ *  about their target measure, so that the Hessian has no empty rows */
+bool CDomainOptimalTransport::__detri2_repair_WDT(detri2::Triangulation *pTr)
+{
+    std::vector<double> weight = m_state.weight;
+    if (!__detri2_insert_missing_WDT(weight, pTr))
+    {
+        return false;
+    }
+    for (int i = 0; i < m_state.size(); i++)
+    {
+        if (weight[i] != m_state.weight[i])
+        {
+            weight[i] += m_state.target_area[i];
+        }
+    }
+    if (!__detri2_insert_missing_WDT(weight, pTr))
+    {
+        return false;
+    }
+    m_state.weight = weight;
+    return true;
+};
+
+/*! nearest sites by Dijkstra over the uv edge lengths, from all the sites at once */
+void CDomainOptimalTransport::__nearest_sites(std::vector<int> &order, int m, std::vector<int> &site)
+{
+    int n = m_state.size();
+    site.assign(n, -1);
+    std::vector<double> distance(n, std::numeric_limits<double>::max());
+
+    typedef std::pair<double, int> QueueItem;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (int j = 0; j < m; j++)
+    {
+        int i = order[j];
+        distance[i] = 0;
+        site[i] = j;
+        queue.push(QueueItem(0, i));
+    }
+
+    while (!queue.empty())
+    {
+        QueueItem top = queue.top();
+        queue.pop();
+        int i = top.second;
+        if (top.first > distance[i])
+            continue;
+
+        for (COMTMesh::VertexVertexIterator vviter(V[i]); !vviter.end(); ++vviter)
+        {
+            COMTMesh::CVertex *pw = *vviter;
+            int k = pw->index();
+            double d = distance[i] + (V[i]->uv() - pw->uv()).norm();
+            if (d < distance[k])
+            {
+                distance[k] = d;
+                site[k] = site[i];
+                queue.push(QueueItem(d, k));
+            }
+        }
+    }
+};
+
+/*! (H * d)_i = sum_j (dual_length_ij / length_ij) * (d_i - d_j), over the edges of the Weighted Delaunay mesh */
+void CDomainOptimalTransport::__linearized_area_change(std::vector<double> &area_change)
+{
+    area_change.assign(m_state.size(), 0.0);
+
+    for (COMTMesh::MeshEdgeIterator eiter(m_pWDT); !eiter.end(); eiter++)
+    {
+        COMTMesh::CEdge *pe = *eiter;
+        double w = pe->dual_length() / pe->length();
+        int i = m_pWDT->edgeVertex1(pe)->index();
+        int j = m_pWDT->edgeVertex2(pe)->index();
+        double dd = m_state.update_direction[i] - m_state.update_direction[j];
+        area_change[i] += w * dd;
+        area_change[j] -= w * dd;
+    }
+};
 
 } // namespace MeshLib
@@ -6,23 +6,42 @@
  *   Base Class for Planar Optimal Transportation, Semi-Discrete Algorithm
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Mesh/BlockedReduction.h"
 #include "OT.h"
 
 namespace MeshLib
 {
-/*! copy vertex weight, target area and index from the input mesh to the output mesh */
-void CBaseOT::_copy_mesh(COMTMesh *pInput, COMTMesh *pOutput)
+/*! copy vertex weight and target area from the state to the weighted Delaunay mesh, whose vertex id is the index
+ * plus one, and read the dual area and dual center back */
+void CBaseOT::_update_mesh(COMTMesh *pMesh, bool regenerated)
 {
-    for (COMTMesh::MeshVertexIterator viter(pInput), witer(pOutput); !viter.end(); viter++, witer++)
+    for (COMTMesh::MeshVertexIterator witer(pMesh); !witer.end(); witer++)
     {
-        COMTMesh::CVertex *pv = *viter;
         COMTMesh::CVertex *pw = *witer;
-        pw->weight() = pv->weight();
-        pw->target_area() = pv->target_area();
-        pw->index() = pv->index();
-        pw->rgb() = pv->rgb();
-        pw->normal() = pv->normal();
-        pw->string() = pv->string();
+        int i = pw->id() - 1;
+        if (regenerated)
+        {
+            // the base mesh vertices are in the index order
+            pw->index() = i;
+            pw->rgb() = V[i]->rgb();
+            pw->normal() = V[i]->normal();
+        }
+        pw->weight() = m_state.weight[i];
+        pw->target_area() = m_state.target_area[i];
+        m_state.dual_area[i] = pw->dual_area();
+        m_state.dual_center[i] = pw->dual_center();
         double x = pw->dual_center()[0];
         double y = pw->dual_center()[1];
         double z = pw->weight();
@@ -34,58 +53,59 @@ void CBaseOT::_copy_mesh(COMTMesh *pInput, COMTMesh *pOutput)
 /*! normalize the uv coordinates to be within the unit disk */
 void CBaseOT::_normalize_uv(COMTMesh *pMesh)
 {
-    double total_area = 0;
+    std::vector<COMTMesh::CVertex *> vertices(pMesh->vertices().begin(), pMesh->vertices().end());
+    std::vector<COMTMesh::CEdge *> edges(pMesh->edges().begin(), pMesh->edges().end());
+    std::vector<COMTMesh::CFace *> faces(pMesh->faces().begin(), pMesh->faces().end());
+    int nv = (int)vertices.size();
+    int ne = (int)edges.size();
+    int nf = (int)faces.size();
+
     // calculate the total area of the mesh
-    for (COMTMesh::MeshFaceIterator fiter(pMesh); !fiter.end(); ++fiter)
-    {
-        COMTMesh::CFace *pf = *fiter;
+    double total_area = parallel_sum(nf, [&](int i) {
         std::vector<CPoint2> uvs;
-        for (COMTMesh::FaceVertexIterator fviter(pf); !fviter.end(); fviter++)
+        for (COMTMesh::FaceVertexIterator fviter(faces[i]); !fviter.end(); fviter++)
         {
             COMTMesh::CVertex *pv = *fviter;
             uvs.push_back(pv->uv());
         }
-        total_area += (uvs[1] - uvs[0]) ^ (uvs[2] - uvs[0]) / 2;
-    }
+        return (uvs[1] - uvs[0]) ^ (uvs[2] - uvs[0]) / 2;
+    });
 
     std::cout << "Total Area " << total_area << std::endl;
 
-    CPoint2 s(0, 0);
-    double total_length = 0;
-    for (COMTMesh::MeshEdgeIterator eiter(pMesh); !eiter.end(); ++eiter)
+    // the centroid of the boundary, weighted by the edge lengths
+    std::vector<double> boundary_length(ne, 0.0);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < ne; i++)
     {
-        COMTMesh::CEdge *pe = *eiter;
-        if (!pe->boundary())
-            continue;
-
-        COMTMesh::CVertex *pv1 = pMesh->edgeVertex1(pe);
-        COMTMesh::CVertex *pv2 = pMesh->edgeVertex2(pe);
-
-        s += (pv1->uv() + pv2->uv()) * pMesh->edgeLength(pe) / 2.0;
-        total_length += pMesh->edgeLength(pe);
+        if (edges[i]->boundary())
+            boundary_length[i] = pMesh->edgeLength(edges[i]);
     }
+    auto midpoint = [&](int i, int k) {
+        if (boundary_length[i] == 0)
+            return 0.0;
+        COMTMesh::CVertex *pv1 = pMesh->edgeVertex1(edges[i]);
+        COMTMesh::CVertex *pv2 = pMesh->edgeVertex2(edges[i]);
+        return (pv1->uv()[k] + pv2->uv()[k]) * boundary_length[i] / 2.0;
+    };
+    double total_length = parallel_sum(ne, [&](int i) { return boundary_length[i]; });
+    CPoint2 s(parallel_sum(ne, [&](int i) { return midpoint(i, 0); }),
+              parallel_sum(ne, [&](int i) { return midpoint(i, 1); }));
 
     s = s / total_length;
 
-    for (COMTMesh::MeshVertexIterator viter(pMesh); !viter.end(); ++viter)
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < nv; i++)
     {
-        COMTMesh::CVertex *v = *viter;
-        CPoint2 p = v->uv();
-        p = p - s;
-        v->uv() = p;
+        vertices[i]->uv() = vertices[i]->uv() - s;
     }
-    double d = 0;
 
-    for (COMTMesh::MeshVertexIterator viter(pMesh); !viter.end(); ++viter)
-    {
-        COMTMesh::CVertex *v = *viter;
-        CPoint2 p = v->uv();
-        d = (d > p.norm()) ? d : p.norm();
-    }
+    double d = parallel_max(nv, 0.0, [&](int i) { return vertices[i]->uv().norm(); });
 
-    for (COMTMesh::MeshVertexIterator viter(pMesh); !viter.end(); ++viter)
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < nv; i++)
     {
-        COMTMesh::CVertex *v = *viter;
+        COMTMesh::CVertex *v = vertices[i];
         CPoint2 p = v->uv();
         p = p / d;
         v->uv() = p;
@@ -97,44 +117,116 @@ void CBaseOT::_normalize_uv(COMTMesh *pMesh)
 /*! compute the maximal, relative error of the input mesh */
 void CBaseOT::_compute_error(COMTMesh *pMesh)
 {
-    double max_error = -1e+10;
-    double total_error = 0;
-
-    for (COMTMesh::MeshVertexIterator viter(pMesh); !viter.end(); viter++)
-    {
-        COMTMesh::CVertex *pv = *viter;
-        double da = fabs(pv->target_area() - pv->dual_area());
-        double error = da / pv->target_area();
-        if (error > max_error)
-        {
-            max_error = error;
-        }
-        total_error += da * da;
-    }
+    std::vector<COMTMesh::CVertex *> vertices(pMesh->vertices().begin(), pMesh->vertices().end());
+    int n = (int)vertices.size();
+
+    double max_error = parallel_max(n, -1e+10, [&](int i) {
+        COMTMesh::CVertex *pv = vertices[i];
+        return fabs(pv->target_area() - pv->dual_area()) / pv->target_area();
+    });
+    double total_error = parallel_sum(n, [&](int i) {
+        COMTMesh::CVertex *pv = vertices[i];
+        double da = pv->target_area() - pv->dual_area();
+        return da * da;
+    });
     std::cout << "Max relative error is " << max_error << " Total L2 error is " << total_error << std::endl;
 };
 
-/*! solve the linear system */
+/*! maximal relative error of the dual areas in the state, without output */
+double CBaseOT::_max_error()
+{
+    return parallel_max(m_state.size(), 0.0, [&](int i) {
+        return fabs(m_state.target_area[i] - m_state.dual_area[i]) / m_state.target_area[i];
+    });
+};
+
+/*! sum of the squared errors of the dual areas in the state, without output */
+double CBaseOT::_l2_error()
+{
+    return parallel_sum(m_state.size(), [&](int i) {
+        double da = m_state.target_area[i] - m_state.dual_area[i];
+        return da * da;
+    });
+};
+
+/*! solve the grounded hessian, by LDLT, or by preconditioned conjugate gradient for large meshes */
 
-bool CBaseOT::__solve(Eigen::SparseMatrix<double> &A, Eigen::VectorXd &b, Eigen::VectorXd &result)
+bool CBaseOT::__solve(Eigen::VectorXd &b, Eigen::VectorXd &result)
 {
-    // solve the linear system
-    // Eigen::ConjugateGradient<Eigen::SparseMatrix<double> >	solver;
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+    Eigen::SparseMatrix<double> &A = m_hessian.H;
+    auto t0 = std::chrono::steady_clock::now();
 
-    std::cout << "Eigen decomposition:" << std::endl;
-    solver.compute(A);
-    std::cout << "Eigen decomposition finished" << std::endl;
+    if (A.rows() > m_direct_solver_max_size)
+    {
+        // Eigen::ConjugateGradient<Eigen::SparseMatrix<double> >	solver;
+        int iterations = 0;
+        double error = 0;
+        bool converged = false;
+        if (m_pcg_preconditioner == PCG_JACOBI)
+        {
+            Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper,
+                                     Eigen::DiagonalPreconditioner<double>>
+                solver;
+            solver.setTolerance(m_pcg_tolerance);
+            solver.compute(A);
+            result = solver.solve(b);
+            iterations = (int)solver.iterations();
+            error = solver.error();
+            converged = solver.info() == Eigen::Success;
+        }
+        else
+        {
+            Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper,
+                                     Eigen::IncompleteCholesky<double>>
+                solver;
+            solver.setTolerance(m_pcg_tolerance);
+            solver.compute(A);
+            result = solver.solve(b);
+            iterations = (int)solver.iterations();
+            error = solver.error();
+            converged = solver.info() == Eigen::Success;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << "Hessian PCG: " << iterations << " iterations, error " << error << ", solve time "
+                  << std::chrono::duration<double>(t1 - t0).count() << "s" << std::endl;
 
-    if (solver.info() != Eigen::Success)
+        if (!converged)
+        {
+            std::cerr << "Waring: conjugate gradient did not converge!!!!" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // the ordering and the symbolic factorization are reused while the pattern is unchanged
+    bool same_pattern = m_hessian.analyzed && (int)m_hessian.outer.size() == A.outerSize() + 1 &&
+                        (int)m_hessian.inner.size() == A.nonZeros() &&
+                        std::equal(m_hessian.outer.begin(), m_hessian.outer.end(), A.outerIndexPtr()) &&
+                        std::equal(m_hessian.inner.begin(), m_hessian.inner.end(), A.innerIndexPtr());
+    if (!same_pattern)
+    {
+        m_hessian.ldlt.analyzePattern(A);
+        m_hessian.outer.assign(A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1);
+        m_hessian.inner.assign(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros());
+        m_hessian.analyzed = true;
+    }
+    m_hessian.ldlt.factorize(A);
+    auto t1 = std::chrono::steady_clock::now();
+
+    if (m_hessian.ldlt.info() != Eigen::Success)
     {
         std::cerr << "Waring: eigen decomposition failed!!!!" << std::endl;
+        m_hessian.analyzed = false;
         return false;
     }
 
-    result = solver.solve(b);
+    result = m_hessian.ldlt.solve(b);
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "Hessian LDLT: " << (same_pattern ? "reused" : "new") << " analysis, factor time "
+              << std::chrono::duration<double>(t1 - t0).count() << "s, solve time "
+              << std::chrono::duration<double>(t2 - t1).count() << "s" << std::endl;
 
-    if (solver.info() == Eigen::Success)
+    if (m_hessian.ldlt.info() == Eigen::Success)
     {
         return true;
     }
@@ -146,74 +238,179 @@ bool CBaseOT::__solve(Eigen::SparseMatrix<double> &A, Eigen::VectorXd &b, Eigen:
 
 void CBaseOT::__update_direction(COMTMesh *m_pMesh)
 {
-    /* set vertex ID, index Lookup Table */
-
-    std::vector<int> ids;
-    ids.resize(m_pMesh->numVertices());
-    for (COMTMesh::MeshVertexIterator viter(m_pMesh); !viter.end(); viter++)
-    {
-        COMTMesh::CVertex *pv = *viter;
-        ids[pv->index()] = pv->id();
-    }
-
-    /* set gradient vector */
+    /* set gradient vector, without the grounded last vertex */
 
+    int n = m_state.size() - 1;
     Eigen::VectorXd m_gradient;
-    m_gradient.resize(m_pMesh->numVertices());
-    // m_gradient.resize(m_pMesh->numVertices() + 1);
+    m_gradient.resize(n);
 
-    // #pragma omp parallel for
-    for (int i = 0; i < m_pMesh->numVertices(); ++i)
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i)
     {
-        int id = ids[i];
-        COMTMesh::CVertex *pv = m_pMesh->idVertex(id);
-        double grad = -(pv->target_area() - pv->dual_area());
-        m_gradient[pv->index()] = grad;
+        double grad = -(m_state.target_area[i] - m_state.dual_area[i]);
+        m_gradient[i] = grad;
     }
-    // m_gradient[m_pMesh->numVertices()] = 0;
-
-    // for (COMTMesh::MeshVertexIterator viter(m_pMesh); !viter.end(); viter++)
-    // {
-    //     COMTMesh::CVertex *pv = *viter;
-    //     // compute the gradient for each vertex
-    //     double gradient = -(pv->target_area() - pv->dual_area());
-    //     m_gradient[pv->index()] = gradient;
-    // }
 
     /* compute the Hessian matrix */
-    Eigen::SparseMatrix<double> hessian;
-    __compute_hessian_matrix(*m_pMesh, hessian);
+    __compute_hessian_matrix(*m_pMesh, m_hessian.H);
 
     /* solve hessian equation */
     Eigen::VectorXd m_direction;
-    if (!__solve(hessian, m_gradient, m_direction))
+    if (!__solve(m_gradient, m_direction))
     {
         std::cout << "Numerical Error" << std::endl;
     }
     else
     {
         // m_direction.normalize();
-        // #pragma omp parallel for
-        for (int i = 0; i < m_pMesh->numVertices(); i++)
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++)
         {
-            int id = ids[i];
-            COMTMesh::CVertex *pv = m_pMesh->idVertex(id);
-            pv->update_direction() = m_direction[i];
+            m_state.update_direction[i] = m_direction[i];
         }
+        // the weights are unique up to a constant, the grounded one stays
+        m_state.update_direction[n] = 0;
     }
 };
 
+/*! Set the update direction by the two-loop recursion of L-BFGS, the initial inverse hessian is the scalar
+ *  (s . y) / (y . y) of the newest pair, or the step of the gradient descend if there is no pair yet */
+
+void CBaseOT::__lbfgs_direction()
+{
+    int n = m_state.size();
+
+    std::vector<double> g(n);
+    for (int i = 0; i < n; i++)
+    {
+        g[i] = -(m_state.target_area[i] - m_state.dual_area[i]);
+    }
+
+    /* record the new pair, if the curvature condition s . y > 0 holds */
+    if ((int)m_lbfgs.weight.size() == n)
+    {
+        std::vector<double> s(n), y(n);
+        double sy = 0, ss = 0, yy = 0;
+        for (int i = 0; i < n; i++)
+        {
+            s[i] = m_state.weight[i] - m_lbfgs.weight[i];
+            y[i] = g[i] - m_lbfgs.gradient[i];
+            sy += s[i] * y[i];
+            ss += s[i] * s[i];
+            yy += y[i] * y[i];
+        }
+        if (sy > 1e-10 * sqrt(ss * yy))
+        {
+            m_lbfgs.s.push_back(s);
+            m_lbfgs.y.push_back(y);
+            m_lbfgs.rho.push_back(1.0 / sy);
+            m_lbfgs.gamma = sy / yy;
+        }
+        while ((int)m_lbfgs.s.size() > std::max(m_lbfgs_history, 0))
+        {
+            m_lbfgs.s.pop_front();
+            m_lbfgs.y.pop_front();
+            m_lbfgs.rho.pop_front();
+        }
+    }
+    m_lbfgs.weight = m_state.weight;
+    m_lbfgs.gradient = g;
+
+    /* two-loop recursion */
+    int m = (int)m_lbfgs.s.size();
+    std::vector<double> alpha(m);
+    std::vector<double> d = g;
+    for (int k = m - 1; k >= 0; k--)
+    {
+        double a = 0;
+        for (int i = 0; i < n; i++)
+            a += m_lbfgs.s[k][i] * d[i];
+        alpha[k] = a * m_lbfgs.rho[k];
+        for (int i = 0; i < n; i++)
+            d[i] -= alpha[k] * m_lbfgs.y[k][i];
+    }
+    for (int i = 0; i < n; i++)
+    {
+        d[i] *= m_lbfgs.gamma;
+    }
+    for (int k = 0; k < m; k++)
+    {
+        double b = 0;
+        for (int i = 0; i < n; i++)
+            b += m_lbfgs.y[k][i] * d[i];
+        b *= m_lbfgs.rho[k];
+        for (int i = 0; i < n; i++)
+            d[i] += (alpha[k] - b) * m_lbfgs.s[k][i];
+    }
+
+    /* fall back to the scaled gradient, if it is not a descent direction */
+    double gd = 0;
+    for (int i = 0; i < n; i++)
+        gd += g[i] * d[i];
+    if (!(gd > 0))
+    {
+        std::cout << "L-BFGS: not a descent direction, the history is dropped" << std::endl;
+        m_lbfgs.s.clear();
+        m_lbfgs.y.clear();
+        m_lbfgs.rho.clear();
+        for (int i = 0; i < n; i++)
+            d[i] = m_lbfgs.gamma * g[i];
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        m_state.update_direction[i] = d[i];
+    }
+};
+
+/*! available physical memory in bytes, or the largest value if it is unknown */
+static double available_memory()
+{
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+        return (double)status.ullAvailPhys;
+#elif defined(_SC_AVPHYS_PAGES)
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && page_size > 0)
+        return (double)pages * (double)page_size;
+#endif
+    return std::numeric_limits<double>::max();
+}
+
+/*! Newton's method for meshes up to newton_max_size vertices, whose hessian and its factorization fit into half of the
+ *  available memory. A planar hessian has about 7 nonzeros per row, the LDLT factor about 4 n log2(n) nonzeros, the
+ *  incomplete Cholesky factor of the conjugate gradient about twice the hessian, 12 bytes per nonzero */
+
+bool CBaseOT::_use_newton()
+{
+    double n = (double)m_state.size();
+    if (n > m_newton_max_size)
+        return false;
+
+    double hessian = 7.0 * n;
+    double factor = (n > m_direct_solver_max_size) ? 2.0 * hessian : 4.0 * n * std::log2(std::max(n, 2.0));
+    double bytes = 12.0 * (hessian + factor) + 8.0 * 8.0 * n;
+
+    return bytes < 0.5 * available_memory();
+};
+
 /*! set target area, assume the vertex area has been set already */
 
 void CBaseOT::_set_target_measure(COMTMesh *&pMesh, double total_target_area, bool uniform)
 {
+    std::vector<COMTMesh::CVertex *> vertices(pMesh->vertices().begin(), pMesh->vertices().end());
+    int n = (int)vertices.size();
+
     if (not uniform)
     {
-        double total_area = 0;
         /* compute the vertex area */
-        for (COMTMesh::MeshVertexIterator viter(pMesh); !viter.end(); viter++)
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++)
         {
-            COMTMesh::CVertex *pV = *viter;
+            COMTMesh::CVertex *pV = vertices[i];
             double s = 0;
             for (COMTMesh::VertexFaceIterator vfiter(pV); !vfiter.end(); vfiter++)
             {
@@ -221,32 +418,37 @@ void CBaseOT::_set_target_measure(COMTMesh *&pMesh, double total_target_area, bo
                 s += pF->area();
             }
             pV->target_area() = s / 3.0;
-            total_area += pV->target_area();
         }
+        double total_area = parallel_sum(n, [&](int i) { return vertices[i]->target_area(); });
+
         /*! set the target area proportional to the vertex area*/
-        for (COMTMesh::MeshVertexIterator viter(pMesh); !viter.end(); viter++)
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++)
         {
-            COMTMesh::CVertex *pV = *viter;
-            pV->target_area() *= (total_target_area / total_area);
+            vertices[i]->target_area() *= (total_target_area / total_area);
         }
     }
     else
     {
         std::cout << "setting target measure to uniform" << std::endl;
-        for (COMTMesh::MeshVertexIterator viter(pMesh); !viter.end(); viter++)
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++)
         {
-            COMTMesh::CVertex *pV = *viter;
-            pV->target_area() = total_target_area / pMesh->numVertices();
+            vertices[i]->target_area() = total_target_area / n;
         }
     }
 };
 
-/* compute the hessian matrix */
+/* compute the hessian matrix, the row and the column of the last vertex are removed */
 
 void CBaseOT::__compute_hessian_matrix(COMTMesh &mesh, Eigen::SparseMatrix<double> &hessian)
 {
+    int n = mesh.numVertices() - 1;
     std::vector<Eigen::Triplet<double>> hessian_coefficients;
-    /* all the off diagonal elements */
+    hessian_coefficients.reserve(2 * mesh.numEdges() + n);
+    std::vector<double> diagonal(n, 0.0);
+
+    /* the off diagonal elements, and the diagonal ones as their negative sums */
     for (COMTMesh::MeshEdgeIterator eiter(&mesh); !eiter.end(); eiter++)
     {
         COMTMesh::CEdge *pe = *eiter;
@@ -256,34 +458,46 @@ void CBaseOT::__compute_hessian_matrix(COMTMesh &mesh, Eigen::SparseMatrix<doubl
         COMTMesh::CVertex *pv2 = mesh.edgeVertex2(pe);
         int ids = pv1->index();
         int idt = pv2->index();
-        hessian_coefficients.push_back(Eigen::Triplet<double>(ids, idt, weight));
-        hessian_coefficients.push_back(Eigen::Triplet<double>(idt, ids, weight));
+        if (ids < n)
+            diagonal[ids] -= weight;
+        if (idt < n)
+            diagonal[idt] -= weight;
+        if (ids < n && idt < n)
+        {
+            hessian_coefficients.push_back(Eigen::Triplet<double>(ids, idt, weight));
+            hessian_coefficients.push_back(Eigen::Triplet<double>(idt, ids, weight));
+        }
     }
-    /* all the diagonal elements */
-    for (COMTMesh::MeshVertexIterator viter(&mesh); !viter.end(); viter++)
+    /* after the multiscale warm start a site whose cell is out of the domain has an empty row, it gets the mean
+     * diagonal; otherwise the row is kept, the factorization fails on the degenerate cell */
+    if (m_fill_empty_rows)
     {
-        COMTMesh::CVertex *pv = *viter;
-        double sum = 0;
-        for (COMTMesh::VertexEdgeIterator veiter(pv); !veiter.end(); veiter++)
+        double diagonal_sum = 0;
+        int diagonal_count = 0;
+        for (int i = 0; i < n; i++)
+        {
+            if (diagonal[i] > 0)
+            {
+                diagonal_sum += diagonal[i];
+                diagonal_count++;
+            }
+        }
+        int filled = 0;
+        for (int i = 0; i < n; i++)
         {
-            COMTMesh::CEdge *pe = *veiter;
-            // compute the diagonal element in Hessian matrix
-            double weight = -1.0 * pe->dual_length() / pe->length();
-            sum += weight;
+            if (!(diagonal[i] > 0) && diagonal_count > 0)
+            {
+                diagonal[i] = diagonal_sum / diagonal_count;
+                filled++;
+            }
         }
-        int id = pv->index();
-        hessian_coefficients.push_back(Eigen::Triplet<double>(id, id, -sum));
+        if (filled > 0)
+            std::cerr << "Warning: " << filled << " empty cells in the hessian" << std::endl;
     }
+    for (int i = 0; i < n; i++)
+        hessian_coefficients.push_back(Eigen::Triplet<double>(i, i, diagonal[i]));
 
-    // // heights should add up to zero
-    // for (int i = 0; i < mesh.numVertices() - 1; i++)
-    //     hessian_coefficients.push_back(Eigen::Triplet<double>(mesh.numVertices(), i, 1));
-
-    // hessian_coefficients.push_back(Eigen::Triplet<double>(mesh.numVertices(), mesh.numVertices() - 1, 0));
-
-    // hessian.resize(mesh.numVertices() + 1, mesh.numVertices() + 1);
-
-    hessian.resize(mesh.numVertices(), mesh.numVertices());
+    hessian.resize(n, n);
     hessian.setZero();
     hessian.setFromTriplets(hessian_coefficients.begin(), hessian_coefficients.end());
 };
@@ -46,6 +46,7 @@
 #include "OTMesh.h"
 #include <GL/gl.h>
 #include <cmath>
+#include <fstream>
 #include <omp.h>
 #include <math.h>
 #include <stdio.h>
@@ -405,6 +406,10 @@ void help()
 
     printf(" !  -  Gradient Descent Method\n");
     printf(" &  -  Newton's Method\n");
+    printf(" l  -  L-BFGS Method\n");
+    printf(" o  -  Newton's Method, or L-BFGS for large meshes\n");
+    printf(" M  -  Warm start the weights by the multiscale solver\n");
+    printf(" i  -  Toggle updating the weighted Delaunay by flips\n");
     printf(" e  -  Toggle showing cell\n");
     printf(" g  -  Switch display modes\n");
 
@@ -476,31 +481,38 @@ void key_process(unsigned char key)
     case 'e':
         show_cell = (show_cell + 1) % 2;
         break;
-    case '!': {
-        COMTMesh *pM = NULL;
-        pOT->__gradient_descend(pOT->pWeightedDT(), pM);
-        delete pOT->pWeightedDT();
-        pOT->pWeightedDT() = pM;
-        pOT->_compute_error(pM);
-    }
-    break;
-    case '&': {
-        COMTMesh *pM = NULL;
-        pOT->__newton(pOT->pWeightedDT(), pM);
-        delete pOT->pWeightedDT();
-        pOT->pWeightedDT() = pM;
-        pOT->_compute_error(pM);
-    }
-    break;
+    case 'i':
+        pOT->incremental() = !pOT->incremental();
+        std::cout << "incremental weighted Delaunay: " << pOT->incremental() << std::endl;
+        break;
+    case '!':
+        pOT->__gradient_descend();
+        pOT->_compute_error(pOT->pWeightedDT());
+        break;
+    case '&':
+        pOT->__newton();
+        pOT->_compute_error(pOT->pWeightedDT());
+        break;
+    case 'l':
+        pOT->__quasi_newton();
+        pOT->_compute_error(pOT->pWeightedDT());
+        break;
+    case 'o':
+        pOT->__optimize();
+        pOT->_compute_error(pOT->pWeightedDT());
+        break;
+    case 'M':
+        pOT->_multiscale_initialize();
+        pOT->_compute_error(pOT->pWeightedDT());
+        break;
     case 'u':
-        COMTMesh *wdt_mesh = pOT->pWeightedDT();
         // for (COMTMesh::MeshVertexIterator viter(wdt_mesh); !viter.end(); viter++)
         // {
         //     COMTMesh::CVertex *pv = *viter;
         //     // pv->uv() = CPoint2(pv->point()[0], pv->point()[1]);
         //     pv->point() = CPoint(pv->uv()[0], pv->uv()[1], 0);
         // }
-        pOT->_set_target_measure(wdt_mesh, pOT->total_target_area, true);
+        pOT->set_target_measure_to_uniform();
         // for (COMTMesh::MeshVertexIterator viter(wdt_mesh); !viter.end(); viter++)
         // {
         //     COMTMesh::CVertex *pv = *viter;
@@ -644,6 +656,99 @@ void process_key(char *keys)
     }
 }
 
+/*! command line usage */
+void usage(const char *program)
+{
+    printf("Usage: %s mesh_name [uniform] [options]\n", program);
+    printf(" Without -solve the viewer is opened. Options of the headless solver:\n");
+    printf(" -solve tolerance         iterate until the maximal relative error is at most tolerance\n");
+    printf(" -method name             gd, newton, lbfgs, or auto (default), Newton's method or L-BFGS by the size\n");
+    printf(" -max_iterations n        at most n iterations in total, 1000 by default\n");
+    printf(" -log file                log every iteration, as JSON lines if file ends with .json or .jsonl, else CSV\n");
+    printf(" -checkpoint file         save the weights to the binary file\n");
+    printf(" -checkpoint_interval n   every n iterations, 10 by default\n");
+    printf(" -resume                  start from the checkpoint file if it exists, and continue the log from it\n");
+    printf(" -line_search n           damping evaluates n step lengths concurrently, 1 (sequential) by default\n");
+    printf(" -precheck                skip the step lengths whose linearized areas are far below zero, heuristic,\n");
+    printf("                          it may take a smaller step than the sequential damping\n");
+}
+
+/*! drop the log rows after the iteration of the checkpoint, they are logged again by the resumed run */
+bool truncate_log(const std::string &log_name, int iteration, bool json)
+{
+    std::vector<std::string> lines;
+    {
+        std::ifstream is(log_name.c_str());
+        std::string line;
+        while (std::getline(is, line))
+        {
+            // the CSV header has no iteration
+            size_t pos = 0;
+            if (json)
+            {
+                pos = line.find("\"iteration\": ");
+                pos = (pos == std::string::npos) ? line.size() : pos + 13;
+            }
+            if (pos < line.size() && isdigit((unsigned char)line[pos]) && atoi(line.c_str() + pos) > iteration)
+                break;
+            lines.push_back(line);
+        }
+    }
+
+    std::ofstream os(log_name.c_str(), std::ios::trunc);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        os << lines[i] << std::endl;
+    }
+    return (bool)os;
+}
+
+/*! solve the OT without the viewer, returns the exit code */
+int solve(int method, double tolerance, int max_iterations, const std::string &log_name,
+          const std::string &checkpoint_name, int checkpoint_interval, bool resume)
+{
+    pOT->checkpoint_file() = checkpoint_name;
+    pOT->checkpoint_interval() = checkpoint_interval;
+    bool json = strutil::endsWith(log_name, ".json") || strutil::endsWith(log_name, ".jsonl");
+
+    /*! a checkpoint which exists but does not load is kept, instead of being overwritten by a new run */
+    bool resumed = false;
+    if (resume && !checkpoint_name.empty() && std::ifstream(checkpoint_name.c_str()).good())
+    {
+        if (!pOT->_load_weights(checkpoint_name))
+        {
+            std::cerr << "Error: cannot resume from " << checkpoint_name << std::endl;
+            return EXIT_FAILURE;
+        }
+        resumed = true;
+        std::cout << "resumed from " << checkpoint_name << " at iteration " << pOT->iteration() << std::endl;
+
+        if (!log_name.empty() && !truncate_log(log_name, pOT->iteration(), json))
+        {
+            std::cerr << "Error: cannot write the log " << log_name << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ofstream log;
+    if (!log_name.empty())
+    {
+        log.open(log_name.c_str(), resumed ? std::ios::app : std::ios::trunc);
+        if (!log)
+        {
+            std::cerr << "Error: cannot write the log " << log_name << std::endl;
+            return EXIT_FAILURE;
+        }
+        log.precision(10);
+    }
+
+    bool converged = pOT->_solve(method, tolerance, max_iterations, log_name.empty() ? NULL : &log, json);
+    pOT->_compute_error(pOT->pWeightedDT());
+    std::cout << (converged ? "converged" : "not converged") << " after " << pOT->iteration() << " iterations"
+              << std::endl;
+    return converged ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 /*! main function for viewer
  */
 int main(int argc, char *argv[])
@@ -653,7 +758,7 @@ int main(int argc, char *argv[])
 
     if (argc < 2)
     {
-        printf("Usage: %s mesh_name\n", argv[0]);
+        usage(argv[0]);
         return -1;
     }
 
@@ -677,19 +782,81 @@ int main(int argc, char *argv[])
     }
 
     bool uniform = false;
-    if (argc > 2)
+    bool headless = false;
+    int method = CDomainOptimalTransport::OT_OPTIMIZE;
+    double tolerance = 0;
+    int max_iterations = 1000;
+    std::string log_name;
+    std::string checkpoint_name;
+    int checkpoint_interval = 10;
+    bool resume = false;
+    int line_search_candidates = 1;
+    bool line_search_precheck = false;
+    for (int i = 2; i < argc; i++)
     {
-        std::string uniform_str(argv[2]);
-        uniform = uniform_str == "uniform";
+        std::string arg(argv[i]);
+        bool has_value = i + 1 < argc;
+        if (arg == "uniform")
+            uniform = true;
+        else if (arg == "-solve" && has_value)
+        {
+            headless = true;
+            tolerance = atof(argv[++i]);
+        }
+        else if (arg == "-method" && has_value)
+        {
+            std::string name(argv[++i]);
+            if (name == "gd")
+                method = CDomainOptimalTransport::OT_GRADIENT_DESCEND;
+            else if (name == "newton")
+                method = CDomainOptimalTransport::OT_NEWTON;
+            else if (name == "lbfgs")
+                method = CDomainOptimalTransport::OT_QUASI_NEWTON;
+            else if (name == "auto")
+                method = CDomainOptimalTransport::OT_OPTIMIZE;
+            else
+            {
+                usage(argv[0]);
+                return -1;
+            }
+        }
+        else if (arg == "-max_iterations" && has_value)
+            max_iterations = atoi(argv[++i]);
+        else if (arg == "-log" && has_value)
+            log_name = argv[++i];
+        else if (arg == "-checkpoint" && has_value)
+            checkpoint_name = argv[++i];
+        else if (arg == "-checkpoint_interval" && has_value)
+            checkpoint_interval = atoi(argv[++i]);
+        else if (arg == "-resume")
+            resume = true;
+        else if (arg == "-line_search" && has_value)
+            line_search_candidates = atoi(argv[++i]);
+        else if (arg == "-precheck")
+            line_search_precheck = true;
+        else
+        {
+            usage(argv[0]);
+            return -1;
+        }
     }
 
     std::cout << "uniform: " << uniform << std::endl;
 
     {
         pOT = new CDomainOptimalTransport(&mesh);
+        pOT->line_search_candidates() = line_search_candidates;
+        pOT->line_search_precheck() = line_search_precheck;
         pOT->_initialize(uniform);
     }
 
+    if (headless)
+    {
+        int code = solve(method, tolerance, max_iterations, log_name, checkpoint_name, checkpoint_interval, resume);
+        delete pOT;
+        return code;
+    }
+
     /* glut stuff */
     glutInit(&argc, argv); /* Initialize GLUT */
     glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
@@ -1,6 +1,7 @@
 #ifndef _SPHERICAL_HARMONIC_MAP_H_
 #define _SPHERICAL_HARMONIC_MAP_H_
 
+#include "Mesh/MeshHierarchy.h"
 #include "SphericalHarmonicMapMesh.h"
 #include <vector>
 
@@ -18,7 +19,8 @@ class CSphericalHarmonicMap
     /*!
      *  CSphericalHarmonicMap constructor
      */
-    CSphericalHarmonicMap() : m_pMesh(NULL){};
+    CSphericalHarmonicMap() : m_pMesh(NULL), m_energy_interval(10), m_incremental_energy(false), m_reproducible(false),
+          m_momentum(0.97), m_step(0), m_mobius(false), m_mobius_iterations(0){};
 
     /*!
      *  Set mesh and initialization
@@ -27,8 +29,11 @@ class CSphericalHarmonicMap
     void set_mesh(CSHMMesh *pMesh);
 
     /*!
-     *  Take next one step
-     *  \param step step length
+     *  Take next one step, Jacobi update using the CSR Laplacian,
+     *  all vertices read the previous iterate, so the result does
+     *  not depend on the number of threads.
+     *  \param steps number of steps
+     *  \param step_length step length
      *  \return harmonic energy
      */
     double step_one(int steps = 1, double step_length = 5e-1);
@@ -39,11 +44,96 @@ class CSphericalHarmonicMap
      *  \param epsilon error threshold
      */
     void map(double step_length = 0.01, double epsilon = 1e-3);
+
+    /*!
+     *  The spherical harmonic map by Riemannian descent with heavy-ball
+     *  momentum, the step length is chosen by Armijo backtracking, no
+     *  per-model tuning is needed
+     *  \param epsilon error threshold
+     *  \param interval number of steps between normalizations, the
+     *         momentum restarts after each normalization
+     */
+    void accelerated_map(double epsilon = 1e-3, int interval = 100);
+
+    /*!
+     *  Coarse to fine spherical harmonic map, the coarsest level starts
+     *  from the normals, each finer level starts from the prolongated map
+     *  of the coarser one, and is refined by accelerated_map
+     *  \param hierarchy hierarchy built from the current mesh
+     *  \param epsilon error threshold
+     */
+    void multires_map(CMeshHierarchy<CSHMMesh> &hierarchy, double epsilon = 1e-3);
+
     /*
-     *   normalize the mapping
+     *   normalize the mapping, move the area weighted mass center of
+     *   the image buffers to the origin, by _mobius_normalize if mobius()
+     *   is set, otherwise by a translation followed by a reprojection
      */
     void _normalize();
 
+    /*!
+     *  Moebius balancing, Newton iterations on the Moebius transformations
+     *  x -> (1 - |c|^2) (x - c) / |x - c|^2 - c of the unit sphere, until
+     *  the area weighted mass center of the image is at the origin
+     *  \param tolerance norm of the mass center to stop at
+     *  \param max_iterations maximal number of Newton iterations
+     *  \return number of Newton iterations
+     */
+    int _mobius_normalize(double tolerance = 1e-10, int max_iterations = 50);
+
+    /*!
+     *  Number of steps between two energy evaluations in map()
+     */
+    int &energy_interval()
+    {
+        return m_energy_interval;
+    };
+
+    /*!
+     *  If true, step_one returns the energy u^T (D - W) u of the iterate
+     *  before the last step, obtained from the SpMV of that step, instead
+     *  of a separate pass over the edges after normalization
+     */
+    bool &incremental_energy()
+    {
+        return m_incremental_energy;
+    };
+
+    /*!
+     *  If true, the energies and the descent products are summed in
+     *  fixed-size blocks, so that the results do not depend on the number
+     *  of threads; the mass center and moments always are
+     */
+    bool &reproducible()
+    {
+        return m_reproducible;
+    };
+
+    /*!
+     *  Momentum coefficient of accelerated_map, 0 is plain gradient descent
+     */
+    double &momentum()
+    {
+        return m_momentum;
+    };
+
+    /*!
+     *  If true, _normalize balances the image by Moebius transformations,
+     *  otherwise it centers the image by a translation, the default
+     */
+    bool &mobius()
+    {
+        return m_mobius;
+    };
+
+    /*!
+     *  Number of Newton iterations of the last Moebius normalization
+     */
+    int mobius_iterations()
+    {
+        return m_mobius_iterations;
+    };
+
   protected:
     /*!
      *  Compute vertex normal
@@ -56,11 +146,18 @@ class CSphericalHarmonicMap
     void _calculate_edge_weight();
 
     /*!
-     *  Compute harmonic energy
+     *  Compute harmonic energy of the image buffers
      *  \return harmonic energy
      */
     double _calculate_harmonic_energy();
 
+    /*!
+     *  Compute harmonic energy of an image
+     *  \param u image coordinates, one array per component
+     *  \return harmonic energy
+     */
+    double _calculate_harmonic_energy(const std::vector<double> *u);
+
     /*!
      * Compute angle using cosine law
      * \param a first edge length
@@ -70,6 +167,46 @@ class CSphericalHarmonicMap
      */
     double _inverse_cosine_law(double a, double b, double c);
 
+    /*!
+     *  Assemble the cotangent weights into a CSR matrix, rows and
+     *  columns are the vertex indices idx()
+     */
+    void _assemble_laplacian();
+
+    /*!
+     *  Copy vertex->u() to the flat image buffers
+     */
+    void _gather_u();
+
+    /*!
+     *  Copy the flat image buffers back to vertex->u()
+     */
+    void _scatter_u();
+
+    /*!
+     *  m_lap = (W - D) m_u, the 3-column Laplacian as a single SpMV
+     */
+    void _apply_laplacian();
+
+    /*!
+     *  One explicit step: the 3-column Laplacian as a single SpMV from
+     *  m_u into m_lap, then tangent projection, update and normalization
+     *  to the unit sphere fused in one pass from m_u into m_u_next.
+     *  \param step_length step length
+     *  \return harmonic energy of the iterate before the step
+     */
+    double _jacobi_step(double step_length);
+
+    /*!
+     *  One step of accelerated_map: the search direction is the tangent
+     *  Laplacian plus the previous direction projected to the new tangent
+     *  planes, the step length starts from twice the last accepted one and
+     *  is halved until the Armijo condition holds
+     *  \param restart drop the previous direction
+     *  \return harmonic energy after the step
+     */
+    double _descent_step(bool restart);
+
   protected:
     /*!
      * The input surface mesh
@@ -77,6 +214,47 @@ class CSphericalHarmonicMap
     CSHMMesh *m_pMesh;
     std::vector<CSHMMesh::CVertex *> V;
     std::vector<CSHMMesh::CEdge *> E;
+
+    /*! CSR row offsets of the Laplacian, size V.size() + 1 */
+    std::vector<int> m_row;
+    /*! CSR column indices (neighbor vertex indices) */
+    std::vector<int> m_col;
+    /*! CSR edge weights */
+    std::vector<double> m_val;
+    /*! sum of the edge weights of each row */
+    std::vector<double> m_diag;
+
+    /*! image coordinates, one array per component */
+    std::vector<double> m_u[3];
+    /*! image coordinates of the next iterate */
+    std::vector<double> m_u_next[3];
+    /*! Laplacian of the image coordinates */
+    std::vector<double> m_lap[3];
+
+    /*! edge end vertex indices, two per edge */
+    std::vector<int> m_edge;
+    /*! edge weights, in the order of m_edge */
+    std::vector<double> m_edge_weight;
+    /*! vertex areas */
+    std::vector<double> m_area;
+
+    /*! number of steps between energy evaluations in map() */
+    int m_energy_interval;
+    /*! use the energy from the SpMV of the last step */
+    bool m_incremental_energy;
+    /*! thread-count independent reductions */
+    bool m_reproducible;
+
+    /*! search direction of the accelerated descent */
+    std::vector<double> m_dir[3];
+    /*! momentum coefficient */
+    double m_momentum;
+    /*! last accepted step length */
+    double m_step;
+    /*! Moebius normalization switch */
+    bool m_mobius;
+    /*! Newton iterations of the last Moebius normalization */
+    int m_mobius_iterations;
 };
 } // namespace MeshLib
 #endif // !_SPHERICAL_HARMONIC_MAP_H_
@@ -26,7 +26,7 @@ class CSHMVertex : public CVertex
 {
   public:
     /*! Constructor */
-    CSHMVertex() : m_u(0, 0, 0){};
+    CSHMVertex() : m_u(0, 0, 0), m_index(0){};
 
     /*!	Vertex spherical harmonic map image coordinates
      */
@@ -40,12 +40,19 @@ class CSHMVertex : public CVertex
     {
         return m_area;
     };
+    /*! Vertex index */
+    int &idx()
+    {
+        return m_index;
+    };
 
   protected:
     /*! Vertex spherical harmonic map image coordinates */
     CPoint m_u;
     /*! vertex area */
     double m_area;
+    /*! Vertex index */
+    int m_index;
 };
 
 /*! \brief CSHMEdge class
@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <cmath>
 #include <float.h>
 #include <math.h>
 #include <omp.h>
 #include <vector>
 
+#include "Mesh/BlockedReduction.h"
 #include "SphericalHarmonicMap.h"
 
 void MeshLib::CSphericalHarmonicMap::set_mesh(CSHMMesh *pMesh)
@@ -16,11 +18,17 @@ void MeshLib::CSphericalHarmonicMap::set_mesh(CSHMMesh *pMesh)
     auto e_list = m_pMesh->edges();
     E = std::vector<CSHMMesh::CEdge *>(e_list.begin(), e_list.end());
 
+    for (int i = 0; i < V.size(); ++i)
+    {
+        V[i]->idx() = i;
+    }
+
     // 1. compute vertex normal
     _calculate_normal();
 
-    // 2. compute the weights of edges
+    // 2. compute the weights of edges, and store them as a CSR matrix
     _calculate_edge_weight();
+    _assemble_laplacian();
 
     // 3. initialize the map
     using M = CSHMMesh;
@@ -29,6 +37,7 @@ void MeshLib::CSphericalHarmonicMap::set_mesh(CSHMMesh *pMesh)
         M::CVertex *pV = *viter;
         pV->u() = pV->normal();
     }
+    _gather_u();
 }
 
 void MeshLib::CSphericalHarmonicMap::_calculate_normal()
@@ -77,50 +86,174 @@ double MeshLib::CSphericalHarmonicMap::step_one(int steps, double step_length)
         return DBL_MAX;
     }
 
-    using M = CSHMMesh;
+    // 1. update the flat buffers, u() may have been changed outside
+    _gather_u();
 
+    // 2. Jacobi steps, double buffered
+    double E_spmv = 0;
     for (int i = 0; i < steps; ++i)
     {
+        E_spmv = _jacobi_step(step_length);
+    }
 
-#pragma omp parallel for
-        for (int i = 0; i < V.size(); ++i)
+    // 3. normalize the mapping, such that mass center is at the origin
+    _normalize();
+
+    // 4. compute the harmonic energy
+    double E = (m_incremental_energy && steps > 0) ? E_spmv : _calculate_harmonic_energy();
+
+    _scatter_u();
+    std::cout << "After " << steps << " steps, harmonic energy is " << E;
+    if (m_mobius)
+        std::cout << ", Moebius iterations " << m_mobius_iterations;
+    std::cout << std::endl;
+    return E;
+}
+
+void MeshLib::CSphericalHarmonicMap::_assemble_laplacian()
+{
+    using M = CSHMMesh;
+
+    const int n = V.size();
+    m_row.assign(n + 1, 0);
+    m_col.clear();
+    m_val.clear();
+    m_diag.assign(n, 0);
+
+    for (int i = 0; i < n; ++i)
+    {
+        M::CVertex *pV = V[i];
+        for (M::VertexVertexIterator_ vviter(pV); !vviter.end(); vviter++)
         {
-            M::CVertex *pV = V.at(i);
+            M::CVertex *pW = *vviter;
+            M::CEdge *pE = m_pMesh->vertexEdge(pV, pW);
+            m_col.push_back(pW->idx());
+            m_val.push_back(pE->weight());
+            m_diag[i] += pE->weight();
+        }
+        m_row[i + 1] = m_col.size();
+    }
 
-            // for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
-            // {
-            // M::CVertex *pV = *viter;
+    const int ne = E.size();
+    m_edge.resize(2 * ne);
+    m_edge_weight.resize(ne);
+    for (int e = 0; e < ne; ++e)
+    {
+        m_edge[2 * e] = m_pMesh->edgeVertex1(E[e])->idx();
+        m_edge[2 * e + 1] = m_pMesh->edgeVertex2(E[e])->idx();
+        m_edge_weight[e] = E[e]->weight();
+    }
 
-            // 1. compute vertex laplacian
-            CPoint laplacian(0, 0, 0);
-            for (M::VertexVertexIterator_ vviter(pV); !vviter.end(); vviter++)
-            {
-                M::CVertex *pW = *vviter;
-                M::CEdge *pE = m_pMesh->vertexEdge(pV, pW);
-                laplacian += (pW->u() - pV->u()) * pE->weight();
-            }
+    m_area.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        m_area[i] = V[i]->area();
+    }
 
-            // 2. get the noraml component
-            CPoint laplacian_normal = pV->u() * (laplacian * pV->u());
+    for (int k = 0; k < 3; k++)
+    {
+        m_u[k].assign(n, 0);
+        m_u_next[k].assign(n, 0);
+        m_lap[k].assign(n, 0);
+        m_dir[k].assign(n, 0);
+    }
+}
 
-            // 3. get the tangent_component
-            CPoint laplacian_tangent = laplacian - laplacian_normal;
+void MeshLib::CSphericalHarmonicMap::_gather_u()
+{
+    const int n = V.size();
+#pragma omp parallel for
+    for (int i = 0; i < n; ++i)
+    {
+        const CPoint &u = V[i]->u();
+        m_u[0][i] = u[0];
+        m_u[1][i] = u[1];
+        m_u[2][i] = u[2];
+    }
+}
 
-            // 4. update u
-            pV->u() += laplacian_tangent * step_length;
+void MeshLib::CSphericalHarmonicMap::_scatter_u()
+{
+    const int n = V.size();
+#pragma omp parallel for
+    for (int i = 0; i < n; ++i)
+    {
+        V[i]->u() = CPoint(m_u[0][i], m_u[1][i], m_u[2][i]);
+    }
+}
 
-            // 5. normalize the vertex->u() to the unit sphere
-            pV->u() /= pV->u().norm();
+void MeshLib::CSphericalHarmonicMap::_apply_laplacian()
+{
+    const int n = V.size();
+    const int *row = m_row.data();
+    const int *col = m_col.data();
+    const double *val = m_val.data();
+    const double *diag = m_diag.data();
+    const double *ux = m_u[0].data(), *uy = m_u[1].data(), *uz = m_u[2].data();
+    double *lx = m_lap[0].data(), *ly = m_lap[1].data(), *lz = m_lap[2].data();
+
+    // laplacian = (W - D) u, all three columns in one sweep
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i)
+    {
+        double sx = 0, sy = 0, sz = 0;
+        for (int k = row[i]; k < row[i + 1]; ++k)
+        {
+            const int j = col[k];
+            const double w = val[k];
+            sx += w * ux[j];
+            sy += w * uy[j];
+            sz += w * uz[j];
         }
+        lx[i] = sx - diag[i] * ux[i];
+        ly[i] = sy - diag[i] * uy[i];
+        lz[i] = sz - diag[i] * uz[i];
     }
+}
 
-    // 6. normalize the mapping, such that mass center is at the origin
-    _normalize();
+double MeshLib::CSphericalHarmonicMap::_jacobi_step(double step_length)
+{
+    const int n = V.size();
+    const double *ux = m_u[0].data(), *uy = m_u[1].data(), *uz = m_u[2].data();
+    const double *lx = m_lap[0].data(), *ly = m_lap[1].data(), *lz = m_lap[2].data();
+    double *vx = m_u_next[0].data(), *vy = m_u_next[1].data(), *vz = m_u_next[2].data();
+
+    // 1. laplacian of the current iterate
+    _apply_laplacian();
+
+    // 2. remove the normal component, update, and project back to the unit sphere;
+    //    u^T (D - W) u is the harmonic energy of the current iterate
+    auto update = [=](int i, double *s) {
+        const double dn = lx[i] * ux[i] + ly[i] * uy[i] + lz[i] * uz[i];
+        s[0] -= dn;
+        const double x = ux[i] + step_length * (lx[i] - dn * ux[i]);
+        const double y = uy[i] + step_length * (ly[i] - dn * uy[i]);
+        const double z = uz[i] + step_length * (lz[i] - dn * uz[i]);
+        const double inv = 1.0 / std::sqrt(x * x + y * y + z * z);
+        vx[i] = x * inv;
+        vy[i] = y * inv;
+        vz[i] = z * inv;
+    };
 
-    // 7. compute the harmonic energy
-    double E = _calculate_harmonic_energy();
-    std::cout << "After " << steps << " steps, harmonic energy is " << E << std::endl;
-    return E;
+    double energy = 0;
+    if (m_reproducible)
+    {
+        blocked_sum<1>(n, update, &energy);
+    }
+    else
+    {
+#pragma omp parallel for simd schedule(static) reduction(+ : energy)
+        for (int i = 0; i < n; ++i)
+        {
+            update(i, &energy);
+        }
+    }
+
+    for (int k = 0; k < 3; k++)
+    {
+        m_u[k].swap(m_u_next[k]);
+    }
+    return energy;
 }
 
 void MeshLib::CSphericalHarmonicMap::map(double step_length, double epsilon)
@@ -131,11 +264,12 @@ void MeshLib::CSphericalHarmonicMap::map(double step_length, double epsilon)
         return;
     }
 
+    _gather_u();
     double E_prev = _calculate_harmonic_energy();
     double E = 0;
     while (true)
     {
-        E = step_one(10, step_length);
+        E = step_one(m_energy_interval, step_length);
 
         if (std::fabs(E - E_prev) < epsilon)
             break;
@@ -143,6 +277,198 @@ void MeshLib::CSphericalHarmonicMap::map(double step_length, double epsilon)
     };
 }
 
+double MeshLib::CSphericalHarmonicMap::_descent_step(bool restart)
+{
+    const int n = V.size();
+    const double *ux = m_u[0].data(), *uy = m_u[1].data(), *uz = m_u[2].data();
+    double *tx = m_lap[0].data(), *ty = m_lap[1].data(), *tz = m_lap[2].data();
+    double *dx = m_dir[0].data(), *dy = m_dir[1].data(), *dz = m_dir[2].data();
+    double *vx = m_u_next[0].data(), *vy = m_u_next[1].data(), *vz = m_u_next[2].data();
+
+    // 1. laplacian of the current iterate
+    _apply_laplacian();
+
+    // 2. t = tangent component of the laplacian, the negative Riemannian gradient is 2t;
+    //    the search direction d = t + beta * (previous direction transported to the tangent plane)
+    const double beta = restart ? 0.0 : m_momentum;
+    auto direction = [=](int i, double *s) {
+        const double ln = tx[i] * ux[i] + ty[i] * uy[i] + tz[i] * uz[i];
+        s[0] -= ln;
+        tx[i] -= ln * ux[i];
+        ty[i] -= ln * uy[i];
+        tz[i] -= ln * uz[i];
+
+        const double dn = dx[i] * ux[i] + dy[i] * uy[i] + dz[i] * uz[i];
+        dx[i] = tx[i] + beta * (dx[i] - dn * ux[i]);
+        dy[i] = ty[i] + beta * (dy[i] - dn * uy[i]);
+        dz[i] = tz[i] + beta * (dz[i] - dn * uz[i]);
+
+        s[1] += tx[i] * tx[i] + ty[i] * ty[i] + tz[i] * tz[i];
+        s[2] += tx[i] * dx[i] + ty[i] * dy[i] + tz[i] * dz[i];
+    };
+
+    double E0 = 0, tt = 0, td = 0;
+    if (m_reproducible)
+    {
+        double sum[3];
+        blocked_sum<3>(n, direction, sum);
+        E0 = sum[0];
+        tt = sum[1];
+        td = sum[2];
+    }
+    else
+    {
+#pragma omp parallel for simd schedule(static) reduction(+ : E0, tt, td)
+        for (int i = 0; i < n; ++i)
+        {
+            double sum[3] = {0, 0, 0};
+            direction(i, sum);
+            E0 += sum[0];
+            tt += sum[1];
+            td += sum[2];
+        }
+    }
+
+    // not a descent direction, fall back to the gradient
+    if (td <= 1e-3 * tt)
+    {
+        m_dir[0] = m_lap[0];
+        m_dir[1] = m_lap[1];
+        m_dir[2] = m_lap[2];
+        td = tt;
+    }
+
+    // 3. Armijo backtracking along the retraction u -> (u + a d) / |u + a d|,
+    //    the directional derivative of the energy is -2 t.d
+    const double c = 1e-4;
+    double a = 2.0 * m_step;
+    for (int trial = 0; trial < 40; ++trial, a *= 0.5)
+    {
+#pragma omp parallel for simd schedule(static)
+        for (int i = 0; i < n; ++i)
+        {
+            const double x = ux[i] + a * dx[i];
+            const double y = uy[i] + a * dy[i];
+            const double z = uz[i] + a * dz[i];
+            const double inv = 1.0 / std::sqrt(x * x + y * y + z * z);
+            vx[i] = x * inv;
+            vy[i] = y * inv;
+            vz[i] = z * inv;
+        }
+
+        double E1 = _calculate_harmonic_energy(m_u_next);
+        if (E1 <= E0 - c * a * 2.0 * td)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                m_u[k].swap(m_u_next[k]);
+            }
+            m_step = a;
+            return E1;
+        }
+    }
+
+    // no decrease along d, the iterate is kept and the momentum dropped
+    for (int k = 0; k < 3; k++)
+    {
+        std::fill(m_dir[k].begin(), m_dir[k].end(), 0.0);
+    }
+    return E0;
+}
+
+void MeshLib::CSphericalHarmonicMap::accelerated_map(double epsilon, int interval)
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
+    }
+
+    // the initial trial step is the stable step of the explicit scheme
+    double max_diag = *std::max_element(m_diag.begin(), m_diag.end());
+    m_step = 0.5 / max_diag;
+
+    _gather_u();
+    double E_prev = _calculate_harmonic_energy();
+    double E = 0;
+    int iterations = 0;
+    while (true)
+    {
+        // the normalization moves the iterate, restart the momentum after it
+        for (int i = 0; i < interval; ++i)
+        {
+            E = _descent_step(i == 0);
+        }
+        iterations += interval;
+
+        _normalize();
+        E = _calculate_harmonic_energy();
+        std::cout << "After " << iterations << " steps, harmonic energy is " << E << ", step length " << m_step;
+        if (m_mobius)
+            std::cout << ", Moebius iterations " << m_mobius_iterations;
+        std::cout << std::endl;
+
+        if (std::fabs(E - E_prev) < epsilon)
+            break;
+        E_prev = E;
+    }
+
+    _scatter_u();
+}
+
+void MeshLib::CSphericalHarmonicMap::multires_map(CMeshHierarchy<CSHMMesh> &hierarchy, double epsilon)
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
+    }
+
+    using M = CSHMMesh;
+
+    // images of all vertices, indexed by the hierarchy
+    std::vector<CPoint> u(hierarchy.numVertices(0));
+
+    const int coarsest = hierarchy.levels() - 1;
+    for (int level = coarsest; level >= 0; --level)
+    {
+        // the finest level is the current mesh, coarser ones get their own mapper
+        CSphericalHarmonicMap coarse;
+        CSphericalHarmonicMap &mapper = (level == 0) ? *this : coarse;
+        M *pMesh = (level == 0) ? m_pMesh : hierarchy.mesh(level);
+        if (level > 0)
+        {
+            coarse.momentum() = m_momentum;
+            coarse.reproducible() = m_reproducible;
+            coarse.mobius() = m_mobius;
+            coarse.set_mesh(pMesh);
+        }
+
+        if (level < coarsest)
+        {
+            hierarchy.prolong(level + 1, u);
+            for (M::MeshVertexIterator_ viter(pMesh); !viter.end(); ++viter)
+            {
+                M::CVertex *pV = *viter;
+                CPoint p = u[hierarchy.index(pV->id())];
+                pV->u() = p / p.norm();
+            }
+        }
+
+        std::cout << "Level " << level << ", " << pMesh->numVertices() << " vertices" << std::endl;
+        mapper.accelerated_map(epsilon);
+
+        for (M::MeshVertexIterator_ viter(pMesh); !viter.end(); ++viter)
+        {
+            M::CVertex *pV = *viter;
+            u[hierarchy.index(pV->id())] = pV->u();
+        }
+
+        if (level > 0)
+            delete pMesh;
+    }
+}
+
 void MeshLib::CSphericalHarmonicMap::_calculate_edge_weight()
 {
     using M = CSHMMesh;
@@ -202,27 +528,33 @@ void MeshLib::CSphericalHarmonicMap::_calculate_edge_weight()
 
 double MeshLib::CSphericalHarmonicMap::_calculate_harmonic_energy()
 {
-    using M = CSHMMesh;
+    return _calculate_harmonic_energy(m_u);
+}
 
-    double energy = 0;
+double MeshLib::CSphericalHarmonicMap::_calculate_harmonic_energy(const std::vector<double> *u)
+{
+    const int ne = m_edge_weight.size();
+    const int *ev = m_edge.data();
+    const double *ew = m_edge_weight.data();
+    const double *ux = u[0].data(), *uy = u[1].data(), *uz = u[2].data();
+
+    auto edge_energy = [=](int e, double *s) {
+        const int i = ev[2 * e], j = ev[2 * e + 1];
+        const double dx = ux[i] - ux[j], dy = uy[i] - uy[j], dz = uz[i] - uz[j];
+        s[0] += ew[e] * (dx * dx + dy * dy + dz * dz);
+    };
 
-    // #pragma omp parallel for
-    //     for (int i = 0; i < E.size(); ++i)
-    //     {
-    //         M::CEdge *pE = E.at(i);
-    //         M::CVertex *pV = m_pMesh->edgeVertex1(pE);
-    //         M::CVertex *pW = m_pMesh->edgeVertex2(pE);
-    //         CPoint d = pV->u() - pW->u();
-    //         energy += pE->weight() * (d * d);
-    //     }
+    double energy = 0;
+    if (m_reproducible)
+    {
+        blocked_sum<1>(ne, edge_energy, &energy);
+        return energy;
+    }
 
-    for (M::MeshEdgeIterator_ eiter(m_pMesh); !eiter.end(); ++eiter)
+#pragma omp parallel for schedule(static) reduction(+ : energy)
+    for (int e = 0; e < ne; ++e)
     {
-        M::CEdge *pE = *eiter;
-        M::CVertex *pV = m_pMesh->edgeVertex1(pE);
-        M::CVertex *pW = m_pMesh->edgeVertex2(pE);
-        CPoint d = pV->u() - pW->u();
-        energy += pE->weight() * (d * d);
+        edge_energy(e, &energy);
     }
 
     return energy;
@@ -237,44 +569,114 @@ double MeshLib::CSphericalHarmonicMap::_inverse_cosine_law(double a, double b, d
 
 void MeshLib::CSphericalHarmonicMap::_normalize()
 {
-    using M = CSHMMesh;
+    if (m_mobius)
+    {
+        _mobius_normalize();
+        return;
+    }
 
-    CPoint center(0, 0, 0);
-    double area = 0;
+    const int n = m_area.size();
+    const double *A = m_area.data();
+    double *ux = m_u[0].data(), *uy = m_u[1].data(), *uz = m_u[2].data();
 
-    // move the mass center of vertex->u() to the origin
+    // move the mass center of the image to the origin
+    auto mass = [=](int i, double *s) {
+        s[0] += ux[i] * A[i];
+        s[1] += uy[i] * A[i];
+        s[2] += uz[i] * A[i];
+        s[3] += A[i];
+    };
 
-    // #pragma omp parallel for
-    //     for (int i = 0; i < V.size(); ++i)
-    //     {
-    //         M::CVertex *pV = V.at(i);
-    //         double A = pV->area();
-    //         center += pV->u() * A;
-    //         area += A;
-    //     }
+    // the block partials also serve without m_reproducible, array reductions need OpenMP 4.5
+    double sum[4];
+    blocked_sum<4>(n, mass, sum);
 
-    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    const double cx = sum[0] / sum[3], cy = sum[1] / sum[3], cz = sum[2] / sum[3];
+
+#pragma omp parallel for simd schedule(static)
+    for (int i = 0; i < n; ++i)
     {
-        M::CVertex *pV = *viter;
-        double A = pV->area();
-        center += pV->u() * A;
-        area += A;
+        const double x = ux[i] - cx, y = uy[i] - cy, z = uz[i] - cz;
+        const double inv = 1.0 / std::sqrt(x * x + y * y + z * z);
+        ux[i] = x * inv;
+        uy[i] = y * inv;
+        uz[i] = z * inv;
     }
+}
 
-    center /= area;
-
-    // #pragma omp parallel for
-    //     for (int i = 0; i < V.size(); ++i)
-    //     {
-    //         M::CVertex *pV = V.at(i);
-    //         pV->u() = pV->u() - center;
-    //         pV->u() /= pV->u().norm();
-    //     }
+int MeshLib::CSphericalHarmonicMap::_mobius_normalize(double tolerance, int max_iterations)
+{
+    const int n = m_area.size();
+    const double *A = m_area.data();
+    double *ux = m_u[0].data(), *uy = m_u[1].data(), *uz = m_u[2].data();
+
+    // mass center, total area and second moments of the image
+    auto moments = [=](int i, double *s) {
+        const double x = ux[i], y = uy[i], z = uz[i], a = A[i];
+        s[0] += a * x;
+        s[1] += a * y;
+        s[2] += a * z;
+        s[3] += a;
+        s[4] += a * x * x;
+        s[5] += a * y * y;
+        s[6] += a * z * z;
+        s[7] += a * x * y;
+        s[8] += a * y * z;
+        s[9] += a * z * x;
+    };
 
-    for (M::MeshVertexIterator_ viter(m_pMesh); !viter.end(); ++viter)
+    int iterations = 0;
+    for (; iterations < max_iterations; ++iterations)
     {
-        M::CVertex *pV = *viter;
-        pV->u() = pV->u() - center;
-        pV->u() /= pV->u().norm();
+        double s[10];
+        blocked_sum<10>(n, moments, s);
+
+        const double m[3] = {s[0] / s[3], s[1] / s[3], s[2] / s[3]};
+        if (std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]) < tolerance)
+            break;
+
+        // the transformation of c moves the mass center by -2 (I - M) c to
+        // first order, M the second moment matrix; solve (I - M) c = m / 2
+        const double h00 = 1 - s[4] / s[3], h11 = 1 - s[5] / s[3], h22 = 1 - s[6] / s[3];
+        const double h01 = -s[7] / s[3], h12 = -s[8] / s[3], h20 = -s[9] / s[3];
+        const double i00 = h11 * h22 - h12 * h12, i01 = h20 * h12 - h01 * h22, i02 = h01 * h12 - h20 * h11;
+        const double i11 = h00 * h22 - h20 * h20, i12 = h01 * h20 - h00 * h12, i22 = h00 * h11 - h01 * h01;
+        const double det = h00 * i00 + h01 * i01 + h20 * i02;
+        if (std::fabs(det) < 1e-15)
+        {
+            std::cerr << "Warning: degenerate image, Moebius normalization stopped" << std::endl;
+            break;
+        }
+
+        double c[3] = {0.5 * (i00 * m[0] + i01 * m[1] + i02 * m[2]) / det,
+                       0.5 * (i01 * m[0] + i11 * m[1] + i12 * m[2]) / det,
+                       0.5 * (i02 * m[0] + i12 * m[1] + i22 * m[2]) / det};
+
+        // stay well inside the unit ball, far from the singular transformations
+        const double cn = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+        if (cn > 0.5)
+        {
+            c[0] *= 0.5 / cn;
+            c[1] *= 0.5 / cn;
+            c[2] *= 0.5 / cn;
+        }
+        const double cx = c[0], cy = c[1], cz = c[2];
+        const double k = 1 - (cx * cx + cy * cy + cz * cz);
+
+#pragma omp parallel for simd schedule(static)
+        for (int i = 0; i < n; ++i)
+        {
+            const double dx = ux[i] - cx, dy = uy[i] - cy, dz = uz[i] - cz;
+            const double w = k / (dx * dx + dy * dy + dz * dz);
+            const double x = w * dx - cx, y = w * dy - cy, z = w * dz - cz;
+            // the transformation keeps the unit sphere, renormalize the round-off only
+            const double inv = 1.0 / std::sqrt(x * x + y * y + z * z);
+            ux[i] = x * inv;
+            uy[i] = y * inv;
+            uz[i] = z * inv;
+        }
     }
+
+    m_mobius_iterations = iterations;
+    return iterations;
 }
@@ -1,4 +1,5 @@
 #include <math.h>
+#include <memory>
 #include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -34,6 +35,11 @@ CArcball g_arcball;
 CSHMMesh g_mesh;
 CSphericalHarmonicMap g_mapper;
 
+/* multiresolution hierarchy, built on first use and cached in a file,
+   declared after g_mesh so that it is destroyed first at exit */
+std::unique_ptr<CMeshHierarchy<CSHMMesh>> g_hierarchy;
+std::string g_hierarchy_name;
+
 /*! setup the object, transform from the world to the object coordinate system */
 void setupObject(void)
 {
@@ -178,6 +184,9 @@ void help()
     printf("n  -  Take next one step\n");
     printf("N  -  Take next twenty step\n");
     printf("h  -  Compute the spherical harmonic map\n");
+    printf("a  -  Compute the spherical harmonic map with adaptive step length\n");
+    printf("m  -  Compute the spherical harmonic map coarse to fine\n");
+    printf("b  -  Toggle balancing the map by Moebius transformations\n");
     printf("w  -  Wireframe Display\n");
     printf("f  -  Flat Shading \n");
     printf("s  -  Smooth Shading\n");
@@ -210,6 +219,28 @@ void keyBoard(unsigned char key, int x, int y)
         // spherical harmonic map
         g_mapper.map();
         break;
+    case 'a':
+        // spherical harmonic map, accelerated descent
+        g_mapper.accelerated_map();
+        break;
+    case 'm':
+        // spherical harmonic map, coarse to fine
+        if (!g_hierarchy)
+        {
+            g_hierarchy.reset(new CMeshHierarchy<CSHMMesh>(&g_mesh));
+            if (!g_hierarchy->read(g_hierarchy_name.c_str()))
+            {
+                g_hierarchy->build();
+                g_hierarchy->write(g_hierarchy_name.c_str());
+            }
+        }
+        g_mapper.multires_map(*g_hierarchy);
+        break;
+    case 'b':
+        // Moebius balancing instead of centering
+        g_mapper.mobius() = !g_mapper.mobius();
+        printf("Moebius balancing %s\n", g_mapper.mobius() ? "on" : "off");
+        break;
     case 'f':
         // Flat Shading
         glPolygonMode(GL_FRONT, GL_FILL);
@@ -470,6 +501,7 @@ int main(int argc, char *argv[])
     computeNormal(&g_mesh);
 
     g_mapper.set_mesh(&g_mesh);
+    g_hierarchy_name = mesh_name + ".hier";
 
     help();
 